@@ -0,0 +1,106 @@
+// Hash::crc16 timing: the original bitwise loop against the slicing-by-8 table,
+// on large blocks and on short signature-like slices (single calls and batched).
+
+#include <redasm/support/hash.h>
+#include <redasm/types/buffer/memorybuffer.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define CRC16_BENCH_BUFFER_SIZE (16 * 1024 * 1024)
+#define CRC16_BENCH_SLICES      500000
+#define CRC16_BENCH_MAX_SLICE   48
+#define CRC16_BENCH_ROUNDS      8
+
+using namespace REDasm;
+
+namespace {
+
+u16 bitwiseCRC16(const u8* data, u64 length) // The loop Hash::crc16 used before the table
+{
+    u8 x;
+    u16 crc = 0xFFFF;
+
+    while(length--)
+    {
+        x = crc >> 8 ^ *data++;
+        x ^= x >> 4;
+        crc = (crc << 8) ^ static_cast<u16>(x << 12) ^ static_cast<u16>(x << 5) ^ static_cast<u16>(x);
+    }
+
+    return crc;
+}
+
+template<typename Function> long long measure(const char* name, Function f)
+{
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    printf("%-28s %6lld ms\n", name, static_cast<long long>(elapsed.count()));
+    return elapsed.count();
+}
+
+} // namespace
+
+int main()
+{
+    MemoryBuffer buffer(CRC16_BENCH_BUFFER_SIZE);
+    std::mt19937 rng(1234);
+
+    for(u64 i = 0; i < buffer.size(); i++)
+        buffer.data()[i] = static_cast<u8>(rng());
+
+    Hash::Slices slices(CRC16_BENCH_SLICES);
+    u64 offset = 0;
+
+    for(Hash::Slice& slice : slices) // Fixed runs between wildcards, in offset order like SignatureBuilder's
+    {
+        slice.size = 1 + rng() % CRC16_BENCH_MAX_SLICE;
+        offset += rng() % 8;
+
+        if((offset + slice.size) > buffer.size())
+            offset = 0;
+
+        slice.offset = offset;
+        offset += slice.size;
+    }
+
+    BufferView view = buffer.view();
+    std::vector<u16> expected(slices.size()), single(slices.size()), batch;
+    u16 bigexpected = 0, big = 0;
+    int failed = 0;
+
+    measure("Block, bitwise", [&]() { for(int i = 0; i < CRC16_BENCH_ROUNDS; i++) bigexpected ^= bitwiseCRC16(buffer.data(), buffer.size()); });
+    measure("Block, slicing-by-8", [&]() { for(int i = 0; i < CRC16_BENCH_ROUNDS; i++) big ^= Hash::crc16(buffer.data(), buffer.size()); });
+
+    measure("Slices, bitwise", [&]() {
+        for(size_t i = 0; i < slices.size(); i++)
+            expected[i] = bitwiseCRC16(buffer.data() + slices[i].offset, slices[i].size);
+    });
+
+    measure("Slices, slicing-by-8", [&]() {
+        for(size_t i = 0; i < slices.size(); i++)
+            single[i] = Hash::crc16(buffer.data() + slices[i].offset, slices[i].size);
+    });
+
+    measure("Slices, batch", [&]() { batch = Hash::crc16(view, slices); });
+
+    if(big != bigexpected)
+    {
+        printf("FAIL: block checksum differs\n");
+        failed++;
+    }
+
+    for(size_t i = 0; i < slices.size(); i++)
+    {
+        if((single[i] == expected[i]) && (batch[i] == expected[i]))
+            continue;
+
+        printf("FAIL: slice #%zu (offset %llu, size %llu)\n", i, static_cast<unsigned long long>(slices[i].offset), static_cast<unsigned long long>(slices[i].size));
+        failed++;
+    }
+
+    printf("%d checksum(s) differ\n", failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,274 @@
+// LayeredLayout regression check and timing on synthetic CFGs.
+// The expected hashes come from the original unordered_map based implementation,
+// build with -DLAYOUT_REGRESSION_DUMP against it to regenerate them.
+
+#include <redasm/graph/layout/layeredlayout.h>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#define LAYOUT_REGRESSION_GRAPHS    64
+#define LAYOUT_REGRESSION_MAX_NODES 80
+#define LAYOUT_BENCHMARK_NODES      2000
+
+using namespace REDasm::Graphing;
+
+namespace {
+
+struct SyntheticCFG: public Graph
+{
+    SyntheticCFG(unsigned int seed, int nodecount, bool cyclic) {
+        std::mt19937 rng(seed);
+        std::vector<Node> nodes;
+
+        for(int i = 0; i < nodecount; i++)
+        {
+            Node n = this->newNode();
+            nodes.push_back(n);
+            this->width(n, 40 + rng() % 200);
+            this->height(n, 20 + rng() % 100);
+        }
+
+        this->setRoot(nodes[0]);
+
+        for(int i = 0; i + 1 < nodecount; i++)
+        {
+            if(rng() % 6)                                               // Fallthrough
+                this->newEdge(nodes[i], nodes[i + 1]);
+            else if(i > 0)
+                this->newEdge(nodes[rng() % i], nodes[i + 1]);
+            else
+                this->newEdge(nodes[0], nodes[1]);
+
+            if(!(rng() % 3))                                            // Forward jump
+            {
+                int t = i + 1 + rng() % (nodecount - i - 1);
+
+                if((t != i + 1) && !this->containsEdge(nodes[i], nodes[t]))
+                    this->newEdge(nodes[i], nodes[t]);
+            }
+
+            if(cyclic && !(rng() % 5))                                  // Back jump
+            {
+                int t = rng() % (i + 1);
+
+                if(!this->containsEdge(nodes[i], nodes[t]))
+                    this->newEdge(nodes[i], nodes[t]);
+            }
+        }
+
+        for(const Edge& e : this->edges())
+            this->color(e, "graph_edge");
+    }
+};
+
+unsigned long long mix(unsigned long long h, long long v) { return h ^ (static_cast<unsigned long long>(v) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2)); }
+
+unsigned long long layoutHash(unsigned int seed, bool cyclic)
+{
+    std::mt19937 rng(seed);
+    SyntheticCFG graph(seed, 2 + rng() % LAYOUT_REGRESSION_MAX_NODES, cyclic);
+    LayeredLayout ll(&graph);
+    ll.setLayoutType(seed % 3);
+    ll.execute();
+
+    unsigned long long h = mix(mix(0, graph.areaWidth()), graph.areaHeight());
+
+    for(const Node& n : graph.nodes())
+        h = mix(mix(h, graph.x(n)), graph.y(n));
+
+    for(const Edge& e : graph.edges())
+    {
+        for(const Point& p : graph.routes(e))
+            h = mix(mix(h, p.x), p.y);
+
+        for(const Point& p : graph.arrow(e))
+            h = mix(mix(h, p.x), p.y);
+    }
+
+    return h;
+}
+
+#ifndef LAYOUT_REGRESSION_DUMP
+const unsigned long long EXPECTED[2][LAYOUT_REGRESSION_GRAPHS] = {
+    {
+        0xc9035b565a020096ull,
+        0xf87c68fa975cf614ull,
+        0x9fa0194da131d042ull,
+        0x19605184f30b128aull,
+        0xf75e04b1f2fa63f8ull,
+        0x9c13914cb27d91e7ull,
+        0x43f0ef4c7f107285ull,
+        0x8723b04f963a7ffdull,
+        0xd63f6b46ab2970e6ull,
+        0x56484f50ae6e959full,
+        0x501475d6691248e0ull,
+        0xe26b5e8e55daa156ull,
+        0x1d94210dfa178624ull,
+        0xdaa26039bb866bc2ull,
+        0x2489b9647c91f7fdull,
+        0x47b4816121a54b95ull,
+        0xfe00b4db73793e65ull,
+        0xc35412eca5572833ull,
+        0xde312ce13ebd89d0ull,
+        0xed6ffaacd4eb2621ull,
+        0xbc03c285684c73edull,
+        0xd72d50bcad3fcfc8ull,
+        0x02782ff863c77ea3ull,
+        0xd8d91414e247b893ull,
+        0x5189c9cdf2517470ull,
+        0x4d635ec69a8c62ebull,
+        0x24d7c049526f7599ull,
+        0xfba86b8ee463229full,
+        0x7b364f1ef266699aull,
+        0x2bdf212e7f3e8018ull,
+        0xc404fe751b6c8abbull,
+        0x54df2bf742666adaull,
+        0x56c42dfb720389cbull,
+        0xc8e06057d217707bull,
+        0x7135e7d9642917d6ull,
+        0xf09664b237aeae92ull,
+        0x24357a783d47fc8dull,
+        0x334a41a6db059062ull,
+        0x53ab2a73a2fcb093ull,
+        0xb66de194d38c1174ull,
+        0x68ea60fc92764d75ull,
+        0x2c48914efd7ed8c0ull,
+        0xf13fea75fbbbf001ull,
+        0x01e0d307c987034aull,
+        0x80363bc4c718d9e0ull,
+        0x2b13b7a05446d883ull,
+        0xbb7069e598497621ull,
+        0xdea12ed04b21770bull,
+        0x74573580e7aacdebull,
+        0x47b3bbdaf4037743ull,
+        0x5e3b3d6d15fb2291ull,
+        0xd39f628626fa854bull,
+        0x4e96291432eb785full,
+        0x6a015f7f59c5489eull,
+        0x4258b26e6e707470ull,
+        0x39ee1bca06ae7076ull,
+        0x61cb9f9c14562cb2ull,
+        0x52265316e6105f73ull,
+        0xbb985dd5a7e30a6aull,
+        0x8d5cdb180211c6a7ull,
+        0xdf2819744d911ac5ull,
+        0x4903353de298cb14ull,
+        0xe9e2733918c65e3full,
+        0x74930c5f795dcbe2ull,
+    },
+    {
+        0x729bd57811eca7dfull,
+        0x5fe8bdc760d23ff6ull,
+        0x18a283aa3c3ca82full,
+        0xfa34b2ebc24da495ull,
+        0x9ccf84487dbe8190ull,
+        0xebf5aab3a06ea4a1ull,
+        0xcfe8c4375a65cd58ull,
+        0x4ec4a3cd4565cb76ull,
+        0x459590813b962015ull,
+        0xa5656853d31eda3aull,
+        0x790b5485e83430c7ull,
+        0x9024b52a28a2bfc3ull,
+        0x87629246714f9170ull,
+        0xbe0a47740e0d1b66ull,
+        0xc2752dbadb5841baull,
+        0x162110640a33a642ull,
+        0xd46b57683287f9e8ull,
+        0xb516895690235ba4ull,
+        0x2224d00a94d7c949ull,
+        0x9eb209662542828full,
+        0xd5822928f32010e1ull,
+        0x087caab05579ddf2ull,
+        0xdcc02d8517932f10ull,
+        0xc990d0fde46499c4ull,
+        0xbf2a8c68904209abull,
+        0x5ba7308935b222b8ull,
+        0xa031271dfedc1558ull,
+        0xcc99d3ecd7f2dca9ull,
+        0x972116f310e17010ull,
+        0x3565645d5b5f0414ull,
+        0x6127a625a593e8f0ull,
+        0xd996bf367d0de680ull,
+        0xb258991f769157ecull,
+        0xdbfcc7632dd8a025ull,
+        0x117bf1b09b448646ull,
+        0x59f36607653324a5ull,
+        0x6d34d47ef100ac60ull,
+        0x7136485215954d49ull,
+        0x35c6a95450851ed3ull,
+        0x85ef5c83cf88dcf0ull,
+        0x9bb81d7a7dec5455ull,
+        0xe562f35fdda4090aull,
+        0x00fd34fbc4fb23b4ull,
+        0x19b1c3a49495ba1bull,
+        0xcb0c7da16ea61129ull,
+        0x19e8dd4760337078ull,
+        0x4eb30aa977819feaull,
+        0xae910e89d8f6e85eull,
+        0x6fc940b310f8d338ull,
+        0x942e7597e511cb2aull,
+        0xf6655b0ad71dff39ull,
+        0x15fdb91262902789ull,
+        0x5561fe780e104389ull,
+        0x60df90a13d4403fbull,
+        0x1ad6822a5a962cadull,
+        0xafa8f61668c94d95ull,
+        0x7e5f0a3b76e1594full,
+        0x6735580cc2f2c5c5ull,
+        0x7988b74e0a6fcda8ull,
+        0x03b59ccb5ab3591full,
+        0x3ca65ebd9b431396ull,
+        0x03955eb8c6dc3249ull,
+        0x9c8958326628a8c9ull,
+        0x5ba9f94bbd06df4cull,
+    },
+};
+#endif
+
+} // namespace
+
+int main()
+{
+#ifdef LAYOUT_REGRESSION_DUMP
+    for(int cyclic = 0; cyclic < 2; cyclic++)
+    {
+        printf("    {\n");
+
+        for(unsigned int i = 0; i < LAYOUT_REGRESSION_GRAPHS; i++)
+            printf("        0x%016llxull,\n", layoutHash(i, cyclic));
+
+        printf("    },\n");
+    }
+
+    return 0;
+#else
+    int failed = 0;
+
+    for(int cyclic = 0; cyclic < 2; cyclic++)
+    {
+        for(unsigned int i = 0; i < LAYOUT_REGRESSION_GRAPHS; i++)
+        {
+            if(layoutHash(i, cyclic) == EXPECTED[cyclic][i])
+                continue;
+
+            printf("FAIL: %s graph #%u has a different layout\n", cyclic ? "cyclic" : "acyclic", i);
+            failed++;
+        }
+    }
+
+    for(int cyclic = 0; cyclic < 2; cyclic++)
+    {
+        SyntheticCFG graph(1234, LAYOUT_BENCHMARK_NODES, cyclic);
+        LayeredLayout ll(&graph);
+        auto start = std::chrono::steady_clock::now();
+        ll.execute();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        printf("%s CFG, %d blocks: %lld ms\n", cyclic ? "Cyclic" : "Acyclic", LAYOUT_BENCHMARK_NODES, static_cast<long long>(elapsed.count()));
+    }
+
+    printf("%d/%d layouts differ\n", failed, 2 * LAYOUT_REGRESSION_GRAPHS);
+    return failed ? 1 : 0;
+#endif
+}
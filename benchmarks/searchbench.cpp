@@ -0,0 +1,104 @@
+// Search::find timing: each strategy against std::search, which is what the
+// old BufferView::find loop amounted to, on a low entropy buffer with one
+// match planted near the end.
+
+#include <redasm/support/search/bytesearch.h>
+#include <redasm/support/search/cpufeatures.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define SEARCH_BENCH_BUFFER_SIZE (64 * 1024 * 1024)
+#define SEARCH_BENCH_ROUNDS      4
+
+using namespace REDasm;
+
+namespace {
+
+typedef const u8* (*FindCallback)(const u8*, u64, const u8*, u64);
+
+const u8* findStd(const u8* data, u64 size, const u8* needle, u64 needlesize)
+{
+    const u8* p = std::search(data, data + size, needle, needle + needlesize);
+    return (p != (data + size)) ? p : nullptr;
+}
+
+const u8* findMemchr(const u8* data, u64 size, const u8* needle, u64) { return static_cast<const u8*>(std::memchr(data, needle[0], size)); }
+
+int measure(const char* name, FindCallback cb, const std::vector<u8>& buffer, const std::vector<u8>& needle, const u8* expected)
+{
+    const FindCallback volatile find = cb; // Keeps the rounds from being folded into one call
+    const u8* result = nullptr;
+    auto start = std::chrono::steady_clock::now();
+
+    for(int i = 0; i < SEARCH_BENCH_ROUNDS; i++)
+        result = find(buffer.data(), buffer.size(), needle.data(), needle.size());
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    printf("    %-14s %6lld ms%s\n", name, static_cast<long long>(elapsed.count()), (result == expected) ? "" : "  FAIL");
+    return (result == expected) ? 0 : 1;
+}
+
+} // namespace
+
+int main()
+{
+    std::vector<u8> base(SEARCH_BENCH_BUFFER_SIZE), buffer;
+    std::mt19937 rng(1234);
+    const u8 common[] = { 0x00, 0x00, 0x00, 0xFF, 0x8B, 0x89, 0x48, 0xE8 }; // Code and padding heavy, like an executable
+
+    for(u8& b : base)
+    {
+        b = (rng() % 4) ? common[rng() % sizeof(common)] : static_cast<u8>(rng());
+
+        if(b == 0xCC) // Every needle contains it: the planted one is the only match
+            b = 0x00;
+    }
+
+    const u64 needlesizes[] = { 1, 4, 16, 32, 48, 64, 256 };
+    int failed = 0;
+
+    for(u64 needlesize : needlesizes)
+    {
+        std::vector<u8> needle(needlesize);
+
+        for(u8& b : needle)
+            b = static_cast<u8>(rng());
+
+        // Common first and last bytes keep the filters busy, the 0xCC in the middle keeps the match unique
+        needle[0] = 0x48;
+        needle[needlesize - 1] = 0x8B;
+        needle[needlesize / 2] = 0xCC;
+        buffer = base;
+
+        u64 offset = buffer.size() - needlesize - 4096;
+        std::copy(needle.begin(), needle.end(), buffer.begin() + offset);
+        const u8* expected = buffer.data() + offset;
+
+        printf("Needle of %llu byte(s), 64 MiB x%d:\n", static_cast<unsigned long long>(needlesize), SEARCH_BENCH_ROUNDS);
+        failed += measure("std::search", &findStd, buffer, needle, expected);
+
+        if(needlesize == 1)
+            failed += measure("memchr", &findMemchr, buffer, needle, expected);
+        else
+        {
+            failed += measure("scalar", &Search::Detail::findScalar, buffer, needle, expected);
+
+            if(Search::CPU::hasSSE2())
+                failed += measure("sse2", &Search::Detail::findSSE2, buffer, needle, expected);
+
+            if(Search::CPU::hasAVX2())
+                failed += measure("avx2", &Search::Detail::findAVX2, buffer, needle, expected);
+
+            failed += measure("horspool", &Search::Detail::findHorspool, buffer, needle, expected);
+        }
+
+        failed += measure("Search::find", &Search::find, buffer, needle, expected);
+    }
+
+    printf("%d result(s) differ\n", failed);
+    return failed ? 1 : 0;
+}
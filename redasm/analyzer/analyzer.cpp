@@ -26,8 +26,12 @@ void Analyzer::checkFunctions()
 
 void Analyzer::loadSignatures()
 {
+    SignatureEngine engine(m_disassembler); // Every function is matched against all databases in a single pass
+
     for(const std::string& signame : m_disassembler->loader()->signatures())
-        m_disassembler->loadSignature(signame);
+        engine.load(signame);
+
+    engine.apply();
 }
 
 bool Analyzer::findNullSubs(const Symbol* symbol)
@@ -8,6 +8,7 @@
 #include "../disassembler/types/symboltable.h"
 #include "../disassembler/disassemblerapi.h"
 #include "../database/signaturedb.h"
+#include "../database/signatureengine.h"
 
 namespace REDasm {
 
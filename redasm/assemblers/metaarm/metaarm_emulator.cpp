@@ -4,7 +4,7 @@
 
 namespace REDasm {
 
-MetaARMEmulator::MetaARMEmulator(DisassemblerAPI *disassembler): EmulatorT<u32>(disassembler)
+MetaARMEmulator::MetaARMEmulator(DisassemblerAPI *disassembler): EmulatorT<u32>(disassembler, { ARM_REG_ENDING })
 {
     EMULATE_INSTRUCTION(ARM_INS_ADD, &MetaARMEmulator::emulateMath);
     EMULATE_INSTRUCTION(ARM_INS_ADC, &MetaARMEmulator::emulateMath);
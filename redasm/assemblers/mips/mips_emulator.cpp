@@ -3,7 +3,7 @@
 
 namespace REDasm {
 
-MIPSEmulator::MIPSEmulator(DisassemblerAPI *disassembler): EmulatorT<u32>(disassembler)
+MIPSEmulator::MIPSEmulator(DisassemblerAPI *disassembler): EmulatorT<u32>(disassembler, { MIPS_REG_ENDING })
 {
     EMULATE_INSTRUCTION(MIPS_INS_LB,  &MIPSEmulator::emulateLxx);
     EMULATE_INSTRUCTION(MIPS_INS_LBU, &MIPSEmulator::emulateLxx);
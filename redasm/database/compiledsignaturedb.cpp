@@ -0,0 +1,402 @@
+#include "compiledsignaturedb.h"
+#include "signaturedb.h"
+#include "../plugins/loader.h"
+#include "../types/buffer/memorybuffer.h"
+#include "../types/buffer/mmapbuffer.h"
+#include "../support/utils.h"
+#include "../support/hash.h"
+#include "../redasm_api.h"
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+namespace REDasm {
+
+SignatureChecksums::SignatureChecksums(const BufferView &view): m_view(view) { }
+
+bool SignatureChecksums::checksum(u64 offset, u64 size, u16 *crc)
+{
+    if((offset > m_view.size()) || (size > (m_view.size() - offset)))
+        return false;
+
+    auto key = std::make_pair(offset, size);
+    auto it = m_checksums.find(key);
+
+    if(it == m_checksums.end())
+        it = m_checksums.emplace(key, Hash::crc16(m_view.data() + offset, size)).first;
+
+    *crc = it->second;
+    return true;
+}
+
+void SignatureChecksums::prepare(const Hash::Slices &slices)
+{
+    Hash::Slices missing;
+
+    for(const Hash::Slice& slice : slices)
+    {
+        if((slice.offset > m_view.size()) || (slice.size > (m_view.size() - slice.offset)))
+            continue;
+
+        if(m_checksums.find(std::make_pair(slice.offset, slice.size)) == m_checksums.end())
+            missing.push_back(slice);
+    }
+
+    std::vector<u16> crcs = Hash::crc16(m_view, missing);
+
+    for(size_t i = 0; i < missing.size(); i++)
+        m_checksums.emplace(std::make_pair(missing[i].offset, missing[i].size), crcs[i]);
+}
+
+CompiledSignatureDB::CompiledSignatureDB(): m_header(nullptr), m_signatures(nullptr), m_patterns(nullptr), m_sizes(nullptr), m_prefixes(nullptr), m_strings(nullptr) { }
+bool CompiledSignatureDB::isCompatible(const DisassemblerAPI *disassembler) const { return m_header && (this->assembler() == disassembler->loader()->assembler()); }
+std::string CompiledSignatureDB::assembler() const { return m_header ? this->string(m_header->assembler) : std::string(); }
+std::string CompiledSignatureDB::name() const { return m_header ? this->string(m_header->name) : std::string(); }
+std::string CompiledSignatureDB::name(const SDBSignature *signature) const { return this->string(signature->name); }
+u64 CompiledSignatureDB::size() const { return m_header ? m_header->signaturescount : 0; }
+const SDBSignature *CompiledSignatureDB::at(u64 index) const { return (index < this->size()) ? &m_signatures[index] : nullptr; }
+
+bool CompiledSignatureDB::load(const std::string &sigfilename)
+{
+    if(REDasm::endsWith(sigfilename, ".sdb"))
+        return this->loadCompiled(sigfilename);
+
+    if(REDasm::endsWith(sigfilename, ".json"))
+        return this->loadJson(sigfilename);
+
+    if(std::ifstream(sigfilename + ".sdb").good()) // Prefer the compiled form, when available
+        return this->loadCompiled(sigfilename + ".sdb");
+
+    return this->loadJson(sigfilename + ".json");
+}
+
+bool CompiledSignatureDB::load(const SignatureDB &sigdb) { return this->attach(CompiledSignatureDB::compile(sigdb)); }
+
+void CompiledSignatureDB::search(const BufferView &view, const CompiledSignatureDB::SignatureFound &cb) const
+{
+    SignatureChecksums checksums(view);
+    this->search(checksums, cb);
+}
+
+void CompiledSignatureDB::search(SignatureChecksums &checksums, const CompiledSignatureDB::SignatureFound &cb) const
+{
+    if(!m_header)
+        return;
+
+    const SDBSize* sdbsize = this->findSize(checksums.view().size());
+
+    if(!sdbsize || (static_cast<u64>(sdbsize->firstsignature) + sdbsize->signaturescount > m_header->signaturescount))
+        return;
+
+    const SDBPrefix* it = m_prefixes + sdbsize->firstsignature;
+    const SDBPrefix* end = it + sdbsize->signaturescount;
+    Hash::Slices slices;
+
+    for(const SDBPrefix* p = it; p != end; p++) // Every distinct prefix gets hashed below: do it in one go
+    {
+        if((p == it) || (p->offset != (p - 1)->offset) || (p->size != (p - 1)->size))
+            slices.push_back({ p->offset, p->size });
+    }
+
+    checksums.prepare(slices);
+
+    while(it != end) // One checksum for each distinct (offset, size) prefix
+    {
+        const SDBPrefix* runend = std::find_if(it, end, [it](const SDBPrefix& p) { return (p.offset != it->offset) || (p.size != it->size); });
+
+        u16 checksum = 0;
+
+        if(checksums.checksum(it->offset, it->size, &checksum))
+        {
+            const SDBPrefix* candidate = std::lower_bound(it, runend, checksum, [](const SDBPrefix& p, u16 c) { return p.checksum < c; });
+
+            for( ; (candidate != runend) && (candidate->checksum == checksum); candidate++)
+            {
+                if(candidate->signature >= m_header->signaturescount)
+                    continue;
+
+                const SDBSignature* signature = &m_signatures[candidate->signature];
+
+                if(this->checkPatterns(checksums, signature))
+                    cb(signature);
+            }
+        }
+
+        it = runend;
+    }
+}
+
+bool CompiledSignatureDB::compile(const SignatureDB &sigdb, const std::string &sdbfilename) { return CompiledSignatureDB::write(CompiledSignatureDB::compile(sigdb), sdbfilename); }
+
+bool CompiledSignatureDB::compile(const std::string &name, const std::string &assembler, const SignatureEntries &entries, const std::string &sdbfilename)
+{
+    return CompiledSignatureDB::write(CompiledSignatureDB::compile(name, assembler, entries), sdbfilename);
+}
+
+bool CompiledSignatureDB::write(AbstractBuffer *image, const std::string &sdbfilename)
+{
+    std::unique_ptr<AbstractBuffer> buffer(image);
+    std::ofstream ofs(sdbfilename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if(!ofs.is_open())
+        return false;
+
+    ofs.write(reinterpret_cast<const char*>(buffer->data()), static_cast<std::streamsize>(buffer->size()));
+    return ofs.good();
+}
+
+AbstractBuffer *CompiledSignatureDB::compile(const SignatureDB &sigdb)
+{
+    SignatureEntries entries;
+
+    for(u64 i = 0; i < sigdb.size(); i++)
+    {
+        const json& sig = sigdb.at(i);
+        SignatureEntry entry;
+        entry.name = sig["name"].get<std::string>();
+        entry.symboltype = sig["symboltype"];
+        entry.size = sig["size"];
+
+        for(const json& p : sig["patterns"])
+        {
+            SDBPattern pattern = { };
+            pattern.offset = p["offset"];
+            pattern.size = p["size"];
+            pattern.checksum = p["checksum"];
+            entry.patterns.push_back(pattern);
+        }
+
+        entries.push_back(std::move(entry));
+    }
+
+    return CompiledSignatureDB::compile(sigdb.name(), sigdb.assembler(), entries);
+}
+
+AbstractBuffer *CompiledSignatureDB::compile(const std::string &name, const std::string &assembler, const SignatureEntries &entries)
+{
+    std::vector<size_t> order(entries.size());
+    std::unordered_map<std::string, u32> stringoffsets;
+    std::string strings;
+    u64 patternscount = 0, sizescount = 0;
+
+    auto pushString = [&](const std::string& s) -> u32 {
+        auto it = stringoffsets.find(s);
+
+        if(it != stringoffsets.end())
+            return it->second;
+
+        u32 offset = static_cast<u32>(strings.size());
+        strings.append(s).push_back('\0');
+        stringoffsets[s] = offset;
+        return offset;
+    };
+
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+        patternscount += entries[i].patterns.size();
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t i1, size_t i2) { return entries[i1].size < entries[i2].size; });
+
+    for(size_t i = 0; i < order.size(); i++)
+    {
+        if(!i || (entries[order[i]].size != entries[order[i - 1]].size))
+            sizescount++;
+    }
+
+    SDBHeader header = { };
+    header.magic = SDB_COMPILED_MAGIC;
+    header.version = SDB_COMPILED_VERSION;
+    header.name = pushString(name);
+    header.assembler = pushString(assembler);
+    header.signaturescount = static_cast<u32>(order.size());
+    header.patternscount = static_cast<u32>(patternscount);
+    header.sizescount = static_cast<u32>(sizescount);
+    header.signaturesoffset = sizeof(SDBHeader);
+    header.patternsoffset = header.signaturesoffset + (sizeof(SDBSignature) * header.signaturescount);
+    header.sizesoffset = header.patternsoffset + (sizeof(SDBPattern) * header.patternscount);
+
+    for(size_t idx : order)
+        pushString(entries[idx].name);
+
+    header.stringssize = static_cast<u32>(strings.size());
+    header.prefixesoffset = header.sizesoffset + (sizeof(SDBSize) * header.sizescount);
+    header.stringsoffset = header.prefixesoffset + (sizeof(SDBPrefix) * header.signaturescount);
+
+    MemoryBuffer* buffer = new MemoryBuffer(header.stringsoffset + header.stringssize, 0);
+    SDBSignature* signatures = relpointer<SDBSignature>(buffer->data(), header.signaturesoffset);
+    SDBPattern* patterns = relpointer<SDBPattern>(buffer->data(), header.patternsoffset);
+    SDBSize* sizes = relpointer<SDBSize>(buffer->data(), header.sizesoffset);
+    SDBPrefix* prefixes = relpointer<SDBPrefix>(buffer->data(), header.prefixesoffset);
+    u32 patternidx = 0;
+
+    std::memcpy(buffer->data(), &header, sizeof(SDBHeader));
+    std::copy(strings.begin(), strings.end(), relpointer<char>(buffer->data(), header.stringsoffset));
+
+    for(u32 i = 0; i < header.signaturescount; i++)
+    {
+        const SignatureEntry& entry = entries[order[i]];
+        SDBSignature& signature = signatures[i];
+
+        signature.size = entry.size;
+        signature.name = pushString(entry.name);
+        signature.symboltype = entry.symboltype;
+        signature.firstpattern = patternidx;
+        signature.patternscount = static_cast<u32>(entry.patterns.size());
+
+        for(const SDBPattern& p : entry.patterns)
+        {
+            SDBPattern& pattern = patterns[patternidx++];
+            pattern.offset = p.offset;
+            pattern.size = p.size;
+            pattern.checksum = p.checksum;
+        }
+
+        CompiledSignatureDB::prefixKey(signature, patterns, &prefixes[i]);
+        prefixes[i].signature = i;
+
+        if(!i || (sizes->size != signature.size))
+        {
+            if(i)
+                sizes++;
+
+            sizes->size = signature.size;
+            sizes->firstsignature = i;
+        }
+
+        sizes->signaturescount++;
+    }
+
+    for(u32 i = 0; i < header.sizescount; i++)
+    {
+        const SDBSize& sdbsize = relpointer<SDBSize>(buffer->data(), header.sizesoffset)[i];
+
+        std::sort(prefixes + sdbsize.firstsignature, prefixes + sdbsize.firstsignature + sdbsize.signaturescount, [](const SDBPrefix& p1, const SDBPrefix& p2) {
+            if(p1.offset != p2.offset) return p1.offset < p2.offset;
+            if(p1.size != p2.size) return p1.size < p2.size;
+            if(p1.checksum != p2.checksum) return p1.checksum < p2.checksum;
+            return p1.signature < p2.signature;
+        });
+    }
+
+    return buffer;
+}
+
+bool CompiledSignatureDB::attach(AbstractBuffer *buffer)
+{
+    m_buffer.reset(buffer);
+    m_header = nullptr;
+
+    if(!buffer || (buffer->size() < sizeof(SDBHeader)))
+        return false;
+
+    const SDBHeader* header = reinterpret_cast<const SDBHeader*>(buffer->data());
+
+    if(header->magic != SDB_COMPILED_MAGIC)
+    {
+        REDasm::log("Invalid compiled signature file");
+        return false;
+    }
+
+    if(header->version != SDB_COMPILED_VERSION)
+    {
+        REDasm::log("Invalid version: Expected " + REDasm::quoted(SDB_COMPILED_VERSION) + ", got " + REDasm::quoted(header->version));
+        return false;
+    }
+
+    auto inbounds = [buffer](u64 offset, u64 size) { return (offset <= buffer->size()) && (size <= (buffer->size() - offset)); };
+
+    if(!inbounds(header->signaturesoffset, sizeof(SDBSignature) * static_cast<u64>(header->signaturescount)) ||
+       !inbounds(header->patternsoffset, sizeof(SDBPattern) * static_cast<u64>(header->patternscount)) ||
+       !inbounds(header->sizesoffset, sizeof(SDBSize) * static_cast<u64>(header->sizescount)) ||
+       !inbounds(header->prefixesoffset, sizeof(SDBPrefix) * static_cast<u64>(header->signaturescount)) ||
+       !inbounds(header->stringsoffset, header->stringssize) || !header->stringssize ||
+       buffer->data()[header->stringsoffset + header->stringssize - 1]) // String pool must be terminated
+    {
+        REDasm::log("Corrupted compiled signature file");
+        return false;
+    }
+
+    m_header = header;
+    m_signatures = relpointer<const SDBSignature>(buffer->data(), header->signaturesoffset);
+    m_patterns = relpointer<const SDBPattern>(buffer->data(), header->patternsoffset);
+    m_sizes = relpointer<const SDBSize>(buffer->data(), header->sizesoffset);
+    m_prefixes = relpointer<const SDBPrefix>(buffer->data(), header->prefixesoffset);
+    m_strings = relpointer<const char>(buffer->data(), header->stringsoffset);
+    return true;
+}
+
+bool CompiledSignatureDB::loadCompiled(const std::string &sdbfilename)
+{
+    MMapBuffer* buffer = MMapBuffer::fromFile(sdbfilename);
+
+    if(buffer)
+        buffer->advise(MMapBuffer::Advice::WillNeed); // Every search walks the prefix and pattern tables
+
+    return this->attach(buffer);
+}
+
+bool CompiledSignatureDB::loadJson(const std::string &jsonfilename)
+{
+    SignatureDB sigdb;
+
+    if(!sigdb.load(jsonfilename))
+        return false;
+
+    return this->load(sigdb);
+}
+
+bool CompiledSignatureDB::checkPatterns(SignatureChecksums &checksums, const SDBSignature *signature) const
+{
+    if(static_cast<u64>(signature->firstpattern) + signature->patternscount > m_header->patternscount)
+        return false;
+
+    for(u32 i = 0; i < signature->patternscount; i++)
+    {
+        const SDBPattern& pattern = m_patterns[signature->firstpattern + i];
+        u16 checksum = 0;
+
+        if(!checksums.checksum(pattern.offset, pattern.size, &checksum) || (checksum != pattern.checksum))
+            return false;
+    }
+
+    return true;
+}
+
+const SDBSize *CompiledSignatureDB::findSize(u64 size) const
+{
+    const SDBSize* end = m_sizes + m_header->sizescount;
+    const SDBSize* it = std::lower_bound(m_sizes, end, size, [](const SDBSize& sdbsize, u64 s) { return sdbsize.size < s; });
+    return ((it != end) && (it->size == size)) ? it : nullptr;
+}
+
+void CompiledSignatureDB::prefixKey(const SDBSignature &signature, const SDBPattern *patterns, SDBPrefix *prefix)
+{
+    const SDBPattern* first = nullptr; // Lowest offset: the leading fixed bytes
+
+    for(u32 i = 0; i < signature.patternscount; i++)
+    {
+        const SDBPattern& pattern = patterns[signature.firstpattern + i];
+
+        if(!first || (pattern.offset < first->offset))
+            first = &pattern;
+    }
+
+    if(first)
+    {
+        prefix->offset = first->offset;
+        prefix->size = first->size;
+        prefix->checksum = first->checksum;
+    }
+    else // No fixed bytes: matches every function of this size
+    {
+        prefix->offset = prefix->size = 0;
+        prefix->checksum = Hash::crc16(static_cast<const u8*>(nullptr), 0);
+    }
+}
+
+const char *CompiledSignatureDB::string(u32 offset) const { return (offset < m_header->stringssize) ? (m_strings + offset) : ""; }
+
+} // namespace REDasm
@@ -0,0 +1,127 @@
+#pragma once
+
+#define SDB_COMPILED_MAGIC   0x42445352 // 'RSDB'
+#define SDB_COMPILED_VERSION 2
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <deque>
+#include <vector>
+#include <map>
+#include "../types/buffer/abstractbuffer.h"
+#include "../types/buffer/bufferview.h"
+#include "../types/base_types.h"
+#include "../support/hash.h"
+
+namespace REDasm {
+
+class DisassemblerAPI;
+class SignatureDB;
+
+// Compiled signature database: host endian, every record naturally aligned
+struct SDBHeader
+{
+    u32 magic, version;
+    u32 name, assembler;             // String pool offsets
+    u32 signaturescount, patternscount, sizescount, stringssize;
+    u64 signaturesoffset, patternsoffset, sizesoffset, stringsoffset;
+    u64 prefixesoffset;
+};
+
+struct SDBSignature                  // Sorted by size
+{
+    u64 size;
+    u32 name, symboltype;
+    u32 firstpattern, patternscount;
+};
+
+struct SDBPattern
+{
+    u64 offset, size;
+    u16 checksum;                    // CRC-16
+    u16 reserved[3];
+};
+
+struct SDBPrefix                     // First pattern of a signature, sorted by (offset, size, checksum) in each size bucket
+{
+    u64 offset, size;
+    u16 checksum;
+    u16 reserved;
+    u32 signature;
+};
+
+struct SDBSize                       // Signatures with the same function size, sorted by size
+{
+    u64 size;
+    u32 firstsignature, signaturescount; // Prefixes share the same range
+};
+
+struct SignatureEntry                // Compiler input
+{
+    std::string name;
+    u32 symboltype;
+    u64 size;
+    std::vector<SDBPattern> patterns;
+};
+
+typedef std::deque<SignatureEntry> SignatureEntries;
+
+class SignatureChecksums // CRC-16 of a function's slices, shared by every database it's matched against
+{
+    public:
+        SignatureChecksums(const BufferView& view);
+        const BufferView& view() const { return m_view; }
+        bool checksum(u64 offset, u64 size, u16* crc);     // false: out of bounds
+        void prepare(const Hash::Slices& slices);          // Hashes the missing slices in one pass
+
+    private:
+        BufferView m_view;
+        std::map<std::pair<u64, u64>, u16> m_checksums;
+};
+
+class CompiledSignatureDB
+{
+    public:
+        typedef std::function<void(const SDBSignature*)> SignatureFound;
+
+    public:
+        CompiledSignatureDB();
+        bool isCompatible(const DisassemblerAPI *disassembler) const;
+        std::string assembler() const;
+        std::string name() const;
+        std::string name(const SDBSignature* signature) const;
+        u64 size() const;
+        const SDBSignature* at(u64 index) const;
+        bool load(const std::string& sigfilename); // .sdb is mapped, .json is compiled in memory
+        bool load(const SignatureDB& sigdb);
+        void search(const BufferView& view, const SignatureFound& cb) const;
+        void search(SignatureChecksums& checksums, const SignatureFound& cb) const;
+
+    public:
+        static bool compile(const SignatureDB& sigdb, const std::string& sdbfilename);
+        static bool compile(const std::string& name, const std::string& assembler, const SignatureEntries& entries, const std::string& sdbfilename);
+
+    private:
+        static AbstractBuffer* compile(const SignatureDB& sigdb);
+        static AbstractBuffer* compile(const std::string& name, const std::string& assembler, const SignatureEntries& entries);
+        static bool write(AbstractBuffer* image, const std::string& sdbfilename);
+        bool attach(AbstractBuffer* buffer);
+        bool loadCompiled(const std::string& sdbfilename);
+        bool loadJson(const std::string& jsonfilename);
+        bool checkPatterns(SignatureChecksums& checksums, const SDBSignature* signature) const;
+        const SDBSize* findSize(u64 size) const;
+        static void prefixKey(const SDBSignature& signature, const SDBPattern* patterns, SDBPrefix* prefix);
+        const char* string(u32 offset) const;
+
+    private:
+        std::unique_ptr<AbstractBuffer> m_buffer;
+        const SDBHeader* m_header;
+        const SDBSignature* m_signatures;
+        const SDBPattern* m_patterns;
+        const SDBSize* m_sizes;
+        const SDBPrefix* m_prefixes;
+        const char* m_strings;
+};
+
+} // namespace REDasm
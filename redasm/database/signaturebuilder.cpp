@@ -0,0 +1,230 @@
+#include "signaturebuilder.h"
+#include "../disassembler/disassembler.h"
+#include "../disassembler/listing/listingdocument.h"
+#include "../support/concurrent/parallel.h"
+#include "../types/buffer/mmapbuffer.h"
+#include "../plugins/plugins.h"
+#include "../support/hash.h"
+#include <atomic>
+#include <unordered_set>
+
+namespace REDasm {
+
+SignatureBuilder::SignatureBuilder(const std::string &name): m_name(name) { }
+void SignatureBuilder::add(const std::string &filepath) { m_files.push_back(filepath); }
+size_t SignatureBuilder::size() const { return m_files.size(); }
+
+bool SignatureBuilder::build(const std::string &sdbfilename)
+{
+    std::vector<SignatureEntries> results(m_files.size());
+    std::vector<std::string> assemblers(m_files.size());
+    std::atomic<size_t> pending(m_files.size());
+
+    Parallel::forEach(m_files.size(), [&](size_t i) {
+        results[i] = this->process(m_files[i], &assemblers[i]);
+        REDasm::statusProgress("Building signatures: " + REDasm::fileName(m_files[i]), --pending);
+    });
+
+    // Merge in input order: the output doesn't depend on scheduling
+    std::unordered_set<std::string> seen;
+    SignatureEntries entries;
+    std::string assembler;
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        if(assemblers[i].empty())
+            continue;
+
+        if(assembler.empty())
+            assembler = assemblers[i];
+        else if(assemblers[i] != assembler)
+        {
+            REDasm::log("Skipping " + REDasm::quoted(m_files[i]) + ": expected " + REDasm::quoted(assembler) + " assembler, got " + REDasm::quoted(assemblers[i]));
+            continue;
+        }
+
+        for(SignatureEntry& entry : results[i])
+        {
+            std::string key = entry.name + '\0' + std::to_string(entry.size);
+
+            for(const SDBPattern& pattern : entry.patterns)
+                key += '\0' + std::to_string(pattern.offset) + ':' + std::to_string(pattern.size) + ':' + std::to_string(pattern.checksum);
+
+            if(seen.insert(key).second)
+                entries.push_back(std::move(entry));
+        }
+    }
+
+    if(entries.empty())
+    {
+        REDasm::log("No signatures generated");
+        return false;
+    }
+
+    REDasm::log("Generated " + std::to_string(entries.size()) + " signature(s) from " + std::to_string(m_files.size()) + " file(s)");
+    return CompiledSignatureDB::compile(m_name, assembler, entries, sdbfilename);
+}
+
+SignatureEntries SignatureBuilder::process(const std::string &filepath, std::string *assembler) const
+{
+    SignatureEntries entries;
+    MMapBuffer* buffer = MMapBuffer::fromFile(filepath, MMapBuffer::Access::CopyOnWrite); // Loaders may patch the buffer
+
+    if(!buffer)
+    {
+        REDasm::log("Cannot read " + REDasm::quoted(filepath));
+        return entries;
+    }
+
+    buffer->advise(MMapBuffer::Advice::WillNeed); // The loader and the analysis touch the whole file
+
+    LoadRequest request(filepath, buffer);
+    LoaderList loaders = REDasm::getLoaders(request, true);
+
+    if(loaders.empty())
+    {
+        REDasm::log("Unsupported format: " + REDasm::quoted(filepath));
+        delete buffer;
+        return entries;
+    }
+
+    LoaderPlugin* loader = loaders.front()->init(request); // Takes ownership of the buffer
+    const AssemblerPlugin_Entry* assemblerentry = REDasm::getAssembler(loader->assembler());
+
+    if(!assemblerentry)
+    {
+        REDasm::log("Cannot find " + REDasm::quoted(loader->assembler()) + " assembler");
+        delete loader;
+        return entries;
+    }
+
+    *assembler = loader->assembler();
+
+    // Inputs are already spread over the worker threads: one disassembly job each
+    std::unique_ptr<Disassembler> disassembler(new Disassembler(assemblerentry->init(), loader, 1));
+
+    if(!disassembler->document()->segmentsCount())
+    {
+        REDasm::log("No segments in " + REDasm::quoted(filepath));
+        return entries;
+    }
+
+    disassembler->disassemble();
+    disassembler->waitIdle();
+
+    auto lock = x_lock_safe_ptr(disassembler->document()); // Keeps late writers out while the listing is walked
+
+    lock->symbols()->iterate(SymbolType::FunctionMask, [&](const Symbol* symbol) -> bool {
+        if(!symbol->isLocked() || symbol->isImport()) // Only named functions are worth a signature
+            return true;
+
+        SignatureEntry entry;
+
+        if(SignatureBuilder::extract(disassembler.get(), symbol, &entry))
+            entries.push_back(std::move(entry));
+
+        return true;
+    });
+
+    return entries;
+}
+
+bool SignatureBuilder::extract(DisassemblerAPI *disassembler, const Symbol *symbol, SignatureEntry *entry)
+{
+    auto& document = disassembler->document();
+    auto it = document->functionItem(symbol->address);
+
+    if(it == document->end())
+        return false;
+
+    std::vector< std::pair<u64, u64> > wildcards; // [start, end) relative to the function
+    address_t endaddress = symbol->address;
+
+    for(it++; it != document->end(); it++)
+    {
+        const ListingItem* item = it->get();
+
+        if(item->is(ListingItem::SymbolItem))
+        {
+            const Symbol* s = document->symbol(item->address);
+
+            if(!s || !s->is(SymbolType::Code))
+                break;
+
+            continue;
+        }
+
+        if(!item->is(ListingItem::InstructionItem))
+            break;
+
+        InstructionPtr instruction = document->instruction(item->address);
+
+        if(!instruction || (instruction->address < endaddress))
+            break;
+
+        if(SignatureBuilder::isVariant(disassembler, instruction))
+            wildcards.emplace_back(instruction->address - symbol->address, instruction->endAddress() - symbol->address);
+
+        endaddress = instruction->endAddress();
+    }
+
+    BufferView view = disassembler->loader()->view(symbol->address);
+    u64 size = endaddress - symbol->address, fixedbytes = 0, start = 0;
+
+    if(!size || view.eob() || (view.size() < size))
+        return false;
+
+    view.resize(size);
+    wildcards.emplace_back(size, size); // Sentinel: flushes the last fixed run
+    Hash::Slices slices;
+
+    for(const auto& wildcard : wildcards)
+    {
+        if(wildcard.first > start)
+        {
+            slices.push_back({ start, wildcard.first - start });
+            fixedbytes += wildcard.first - start;
+        }
+
+        start = wildcard.second;
+    }
+
+    if(fixedbytes < SIGNATURE_MIN_FIXED_BYTES)
+        return false;
+
+    std::vector<u16> checksums = Hash::crc16(view, slices);
+
+    for(size_t i = 0; i < slices.size(); i++)
+    {
+        SDBPattern pattern = { };
+        pattern.offset = slices[i].offset;
+        pattern.size = slices[i].size;
+        pattern.checksum = checksums[i];
+        entry->patterns.push_back(pattern);
+    }
+
+    entry->name = symbol->name;
+    entry->symboltype = static_cast<u32>(symbol->type & SymbolType::LockedMask);
+    entry->size = size;
+    return true;
+}
+
+bool SignatureBuilder::isVariant(DisassemblerAPI *disassembler, const InstructionPtr &instruction)
+{
+    // Operand byte positions aren't known: anything that may be relocated hides the whole instruction
+    for(const Operand& op : instruction->operands)
+    {
+        if(op.isTarget() || op.is(OperandType::Memory))
+            return true;
+
+        if(op.is(OperandType::Immediate) && disassembler->document()->segment(op.u_value))
+            return true;
+
+        if(op.displacementCanBeAddress() && disassembler->document()->segment(static_cast<address_t>(op.disp.displacement)))
+            return true;
+    }
+
+    return false;
+}
+
+} // namespace REDasm
@@ -0,0 +1,32 @@
+#pragma once
+
+#define SIGNATURE_MIN_FIXED_BYTES 8 // Fewer fixed bytes than this are too generic to identify a function
+
+#include <deque>
+#include <string>
+#include "compiledsignaturedb.h"
+#include "../disassembler/types/symboltable.h"
+
+namespace REDasm {
+
+class DisassemblerAPI;
+
+class SignatureBuilder // Builds a compiled signature database from a set of binaries
+{
+    public:
+        SignatureBuilder(const std::string& name);
+        void add(const std::string& filepath);
+        size_t size() const;
+        bool build(const std::string& sdbfilename);
+
+    private:
+        SignatureEntries process(const std::string& filepath, std::string* assembler) const;
+        static bool extract(DisassemblerAPI* disassembler, const Symbol* symbol, SignatureEntry* entry);
+        static bool isVariant(DisassemblerAPI* disassembler, const InstructionPtr& instruction);
+
+    private:
+        std::string m_name;
+        std::deque<std::string> m_files;
+};
+
+} // namespace REDasm
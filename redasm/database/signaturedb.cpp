@@ -107,17 +107,8 @@ SignatureDB &SignatureDB::operator <<(const Signature &signature)
 
 void SignatureDB::searchSignature(const BufferView &view, const json &sig, const SignatureDB::SignatureFound &cb) const
 {
-    for(offset_t i = 0; i < view.size(); )
-    {
-        if(!this->checkPatterns(view, i, sig))
-        {
-            i++;
-            continue;
-        }
-
+    if(this->checkPatterns(view, 0, sig)) // Patterns have fixed offsets: one check is enough
         cb(sig);
-        break;
-    }
 }
 
 bool SignatureDB::checkPatterns(const BufferView &view, offset_t offset, const json &sig) const
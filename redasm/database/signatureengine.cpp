@@ -0,0 +1,101 @@
+#include "signatureengine.h"
+#include "../disassembler/disassemblerapi.h"
+#include "../support/concurrent/parallel.h"
+#include "../plugins/loader.h"
+#include "../redasm_api.h"
+
+namespace REDasm {
+
+SignatureEngine::SignatureEngine(DisassemblerAPI *disassembler): m_disassembler(disassembler) { }
+
+bool SignatureEngine::load(const std::string &signame)
+{
+    std::string signaturefile = REDasm::isPath(signame) ? signame : REDasm::makeSignaturePath(signame);
+    std::unique_ptr<CompiledSignatureDB> sigdb = std::make_unique<CompiledSignatureDB>();
+
+    if(!sigdb->load(signaturefile))
+    {
+        REDasm::log("Failed to load " + REDasm::quoted(signaturefile));
+        return false;
+    }
+
+    if(!sigdb->isCompatible(m_disassembler))
+    {
+        REDasm::log("Signature " + REDasm::quoted(sigdb->name()) + " is not compatible");
+        return false;
+    }
+
+    REDasm::log("Loading Signature: " + REDasm::quoted(sigdb->name()));
+    m_databases.push_back(std::move(sigdb));
+    return true;
+}
+
+size_t SignatureEngine::size() const { return m_databases.size(); }
+
+size_t SignatureEngine::apply()
+{
+    if(m_databases.empty())
+        return 0;
+
+    std::deque<Match> matches = this->match();
+
+    for(const Match& m : matches)
+        m_disassembler->document()->lock(m.address, m.database->name(m.signature), static_cast<SymbolType>(m.signature->symboltype));
+
+    if(matches.size())
+        REDasm::log("Found " + std::to_string(matches.size()) + " signature(s)");
+    else
+        REDasm::log("No signatures found");
+
+    return matches.size();
+}
+
+std::deque<SignatureEngine::Match> SignatureEngine::match() const
+{
+    std::deque<address_t> functions;
+    std::deque<BufferView> views;
+
+    m_disassembler->document()->symbols()->iterate(SymbolType::FunctionMask, [&](const Symbol* symbol) -> bool {
+        if(symbol->isLocked())
+            return true;
+
+        BufferView view = m_disassembler->getFunctionBytes(symbol->address);
+        offset_location offset = m_disassembler->loader()->offset(symbol->address);
+
+        if(view.eob() || !offset.valid)
+            return true;
+
+        functions.push_back(symbol->address);
+        views.push_back(view);
+        return true;
+    });
+
+    std::vector<Match> results(functions.size(), Match{ 0, nullptr, nullptr });
+
+    // Views only read the loader's buffer: functions can be matched concurrently
+    Parallel::forEach(functions.size(), [&](size_t i) {
+        SignatureChecksums checksums(views[i]);
+
+        for(const auto& sigdb : m_databases) // The first database that matches wins, as if loaded one by one
+        {
+            sigdb->search(checksums, [&](const SDBSignature* signature) {
+                results[i] = { functions[i], sigdb.get(), signature };
+            });
+
+            if(results[i].signature)
+                break;
+        }
+    }, m_disassembler->concurrency());
+
+    std::deque<Match> matches;
+
+    for(const Match& m : results)
+    {
+        if(m.signature)
+            matches.push_back(m);
+    }
+
+    return matches;
+}
+
+} // namespace REDasm
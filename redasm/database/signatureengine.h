@@ -0,0 +1,28 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include "compiledsignaturedb.h"
+
+namespace REDasm {
+
+class SignatureEngine // Matches every function against a set of signature databases
+{
+    private:
+        struct Match { address_t address; const CompiledSignatureDB* database; const SDBSignature* signature; };
+
+    public:
+        SignatureEngine(DisassemblerAPI* disassembler);
+        bool load(const std::string& signame);
+        size_t size() const;
+        size_t apply(); // Returns the number of functions renamed
+
+    private:
+        std::deque<Match> match() const;
+
+    private:
+        DisassemblerAPI* m_disassembler;
+        std::deque< std::unique_ptr<CompiledSignatureDB> > m_databases;
+};
+
+} // namespace REDasm
@@ -5,14 +5,16 @@
 
 namespace REDasm {
 
-Disassembler::Disassembler(AssemblerPlugin *assembler, LoaderPlugin *loader): DisassemblerBase(assembler, loader)
+Disassembler::Disassembler(AssemblerPlugin *assembler, LoaderPlugin *loader, size_t concurrency): DisassemblerBase(assembler, loader), m_jobs(concurrency), m_dispatching(0), m_analyzed(false), m_idle(false)
 {
     m_algorithm = REDasm::safe_ptr<AssemblerAlgorithm>(m_assembler->createAlgorithm(this));
 
     m_analyzejob.setOneShot(true);
-    EVENT_CONNECT(&m_analyzejob, stateChanged, this, [&](Job*) { busyChanged(); });
+
+    // The one shot analysis job goes inactive when it's done, the fast analysis follows in busyChanged()
+    EVENT_CONNECT(&m_analyzejob, stateChanged, this, [&](Job* job) { this->notifyBusyChanged(job->state() == Job::InactiveState); });
     m_analyzejob.work(std::bind(&Disassembler::analyzeStep, this), true); // Deferred
-    EVENT_CONNECT(&m_jobs, stateChanged, this, [&](Job*) { busyChanged(); });
+    EVENT_CONNECT(&m_jobs, stateChanged, this, [&](Job*) { this->notifyBusyChanged(false); });
 }
 
 void Disassembler::disassembleStep(Job* job)
@@ -41,6 +43,32 @@ void Disassembler::analyzeStep()
         REDasm::log("Analysis completed");
 }
 
+void Disassembler::notifyBusyChanged(bool analyzed)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_idlemutex);
+        m_dispatching++;
+        m_idle = false;
+    }
+
+    busyChanged();
+
+    std::lock_guard<std::mutex> lock(m_idlemutex);
+    m_dispatching--;
+    m_analyzed = m_analyzed || analyzed;
+    m_idle = m_analyzed && !m_dispatching && !this->busy();
+    m_idlecv.notify_all();
+}
+
+void Disassembler::waitIdle()
+{
+    if(REDasm::Context::sync()) // Everything has already run inside disassemble()
+        return;
+
+    std::unique_lock<std::mutex> lock(m_idlemutex);
+    m_idlecv.wait(lock, [&]() { return m_idle; });
+}
+
 void Disassembler::disassemble()
 {
     m_starttime = std::chrono::steady_clock::now();
@@ -85,7 +113,17 @@ void Disassembler::pause() { m_jobs.pause(); }
 void Disassembler::resume() { m_jobs.resume(); }
 size_t Disassembler::state() const { return m_jobs.state(); }
 bool Disassembler::busy() const { return m_analyzejob.active() || m_jobs.active(); }
-void Disassembler::disassembleJob() { m_jobs.work(std::bind(&Disassembler::disassembleStep, this, std::placeholders::_1)); }
+size_t Disassembler::concurrency() const { return m_jobs.concurrency(); }
+
+void Disassembler::disassembleJob()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_idlemutex);
+        m_idle = false;
+    }
+
+    m_jobs.work(std::bind(&Disassembler::disassembleStep, this, std::placeholders::_1));
+}
 
 InstructionPtr Disassembler::disassembleInstruction(address_t address)
 {
@@ -97,6 +135,10 @@ InstructionPtr Disassembler::disassembleInstruction(address_t address)
     instruction = std::make_shared<Instruction>();
     m_algorithm->disassembleInstruction(address, instruction);
     m_algorithm->done(address);
+
+    if(instruction->is(InstructionType::Call))
+        m_callgraph.pushCallSite(address);
+
     return instruction;
 }
 
@@ -4,16 +4,19 @@
 #include "../support/concurrent/jobspool.h"
 #include "listing/listingdocument.h"
 #include "disassemblerbase.h"
+#include <condition_variable>
 #include <chrono>
+#include <mutex>
 
 namespace REDasm {
 
 class Disassembler: public DisassemblerBase
 {
     public:
-        Disassembler(AssemblerPlugin* assembler, LoaderPlugin* loader);
+        Disassembler(AssemblerPlugin* assembler, LoaderPlugin* loader, size_t concurrency = 0);
         virtual ~Disassembler() = default;
         void disassemble() override;
+        void waitIdle(); // Blocks until disassembly and every analysis pass, the fast ones included, are done
 
     public: // Primitive functions
         Printer* createPrinter() override;
@@ -24,18 +27,24 @@ class Disassembler: public DisassemblerBase
         void resume() override;
         size_t state() const override;
         bool busy() const override;
+        size_t concurrency() const override;
 
     private:
         void work();
         void disassembleJob();
         void disassembleStep(Job *job);
         void analyzeStep();
+        void notifyBusyChanged(bool analyzed);
 
     private:
         std::chrono::steady_clock::time_point m_starttime;
         safe_ptr<AssemblerAlgorithm> m_algorithm;
         Job m_analyzejob;
         JobsPool m_jobs;
+        std::condition_variable m_idlecv;
+        std::mutex m_idlemutex;
+        size_t m_dispatching;          // busyChanged() handlers running: the fast analysis is one of them
+        bool m_analyzed, m_idle;
 };
 
 }
@@ -7,6 +7,7 @@
 #include "../support/safe_ptr.h"
 #include "types/symboltable.h"
 #include "types/referencetable.h"
+#include "types/callgraph.h"
 
 namespace REDasm {
 
@@ -30,6 +31,7 @@ class DisassemblerAPI
         virtual safe_ptr<ListingDocumentType>& document() = 0;
         virtual std::deque<ListingItem*> getCalls(address_t address) = 0;
         virtual ReferenceTable* references() = 0;
+        virtual CallGraph* callGraph() = 0;
         virtual Printer* createPrinter() = 0;
         virtual ReferenceVector getReferences(address_t address) const = 0;
         virtual ReferenceSet getTargets(address_t address) const = 0;
@@ -63,6 +65,7 @@ class DisassemblerAPI
         virtual void resume() = 0;
         virtual size_t state() const = 0;
         virtual bool busy() const = 0;
+        virtual size_t concurrency() const = 0; // Upper bound for the threads its own work may use
 };
 
 typedef std::shared_ptr<DisassemblerAPI> DisassemblerPtr;
@@ -1,11 +1,12 @@
 #include "disassemblerbase.h"
-#include "../database/signaturedb.h"
+#include "../database/signatureengine.h"
 #include "../graph/functiongraph.h"
+#include "../support/concurrent/parallel.h"
 #include <cctype>
 
 namespace REDasm {
 
-DisassemblerBase::DisassemblerBase(AssemblerPlugin* assembler, LoaderPlugin *loader): DisassemblerAPI()
+DisassemblerBase::DisassemblerBase(AssemblerPlugin* assembler, LoaderPlugin *loader): DisassemblerAPI(), m_callgraph(this)
 {
     m_loader = std::unique_ptr<LoaderPlugin>(loader);
     m_assembler = std::unique_ptr<AssemblerPlugin>(assembler);
@@ -21,33 +22,18 @@ ReferenceSet DisassemblerBase::getTargets(address_t address) const { return m_re
 ListingItems DisassemblerBase::getCalls(address_t address)
 {
     auto& document = this->document();
-    auto it = document->functionStartItem(address);
+    const ListingItem* functionitem = document->functionStart(address);
     ListingItems calls;
 
-    for( ; it != document->end(); it++)
-    {
-        ListingItem* item = it->get();
-
-        if(item->is(ListingItem::InstructionItem))
-        {
-            InstructionPtr instruction = document->instruction(item->address);
-
-            if(!instruction->is(InstructionType::Call))
-                continue;
+    if(!functionitem)
+        return calls;
 
-            calls.push_back(item);
-        }
-        else if(item->is(ListingItem::SymbolItem))
-        {
-            const Symbol* symbol = document->symbol(item->address);
+    for(address_t callsite : m_callgraph.callSites(functionitem->address))
+    {
+        auto it = document->instructionItem(callsite);
 
-            if(!symbol->is(SymbolType::Code))
-                break;
-        }
-        else if(item->is(ListingItem::FunctionItem) && (item->address == address)) // Skip declaration
-            continue;
-        else
-            break;
+        if(it != document->end())
+            calls.push_back(it->get());
     }
 
     return calls;
@@ -60,14 +46,46 @@ u64 DisassemblerBase::getReferencesCount(address_t address) const { return m_ref
 void DisassemblerBase::computeBasicBlocks()
 {
     auto lock = x_lock_safe_ptr(m_loader->document());
-    lock->functions().invalidateGraphs();
+    std::deque<const ListingItem*> functions = lock->functions().dirtyFunctions(lock.t.get()); // Only rebuild what has changed
+    std::vector< std::unique_ptr<Graphing::FunctionGraph> > graphs(functions.size());
+
+    REDasm::status("Computing basic blocks...");
+
+    // Nobody can write the document while the lock is held: graphs can be built concurrently
+    Parallel::forEach(functions.size(), [&](size_t i) {
+        auto g = std::make_unique<Graphing::FunctionGraph>(this);
+
+        if(g->buildBlocks(functions[i])) // Edges are connected lazily, when a graph is requested
+            graphs[i] = std::move(g);
+    }, this->concurrency());
+
+    ReferenceSet addresses;
+
+    for(size_t i = 0; i < functions.size(); i++)
+    {
+        addresses.insert(functions[i]->address);
+
+        if(graphs[i])
+            lock->functions().blocks(functions[i], std::move(graphs[i]));
+    }
+
+    m_callgraph.invalidate(addresses); // Only call sites of rebuilt functions can change owner
+}
+
+void DisassemblerBase::popTarget(address_t address, address_t pointedby)
+{
+    m_referencetable.popTarget(address, pointedby);
+    this->document()->functions().invalidate(pointedby);
+    m_callgraph.popTarget(address, pointedby);
+}
 
-    for(const ListingItem* item : lock->functions())
-        this->computeBasicBlocks(lock, item);
+void DisassemblerBase::pushTarget(address_t address, address_t pointedby)
+{
+    m_referencetable.pushTarget(address, pointedby);
+    this->document()->functions().invalidate(pointedby);
+    m_callgraph.pushTarget(address, pointedby);
 }
 
-void DisassemblerBase::popTarget(address_t address, address_t pointedby) { m_referencetable.popTarget(address, pointedby); }
-void DisassemblerBase::pushTarget(address_t address, address_t pointedby) { m_referencetable.pushTarget(address, pointedby); }
 void DisassemblerBase::pushReference(address_t address, address_t refby) { m_referencetable.push(address, refby); }
 
 void DisassemblerBase::checkLocation(address_t fromaddress, address_t address)
@@ -165,6 +183,7 @@ s64 DisassemblerBase::checkAddressTable(const InstructionPtr &instruction, addre
 }
 
 ReferenceTable *DisassemblerBase::references() { return &m_referencetable; }
+CallGraph *DisassemblerBase::callGraph() { return &m_callgraph; }
 
 u64 DisassemblerBase::locationIsString(address_t address, bool *wide) const
 {
@@ -365,64 +384,13 @@ std::string DisassemblerBase::readWString(address_t address, u64 len) const
 
 bool DisassemblerBase::loadSignature(const std::string &signame)
 {
-    std::string signaturefile = REDasm::isPath(signame) ? signame : REDasm::makeSignaturePath(signame);
-
-    if(!REDasm::endsWith(signaturefile, ".json"))
-        signaturefile += ".json";
-
-    SignatureDB sigdb;
+    SignatureEngine engine(this);
 
-    if(!sigdb.load(signaturefile))
-    {
-        REDasm::log("Failed to load " + REDasm::quoted(signaturefile));
+    if(!engine.load(signame))
         return false;
-    }
-
-    if(!sigdb.isCompatible(this))
-    {
-        REDasm::log("Signature " + REDasm::quoted(sigdb.name()) + " is not compatible");
-        return false;
-    }
-
-    REDasm::log("Loading Signature: " + REDasm::quoted(sigdb.name()));
-    u64 c = 0;
-
-    this->document()->symbols()->iterate(SymbolType::FunctionMask, [&](const Symbol* symbol) -> bool {
-        if(symbol->isLocked())
-            return true;
-
-        BufferView view = this->getFunctionBytes(symbol->address);
-        offset_location offset = m_loader->offset(symbol->address);
-
-        if(view.eob() || !offset.valid)
-            return true;
-
-        sigdb.search(view, [&](const json& signature) {
-            std::string signame = signature["name"];
-            this->document()->lock(symbol->address, signame, signature["symboltype"]);
-            c++;
-        });
-
-        return true;
-    });
-
-    if(c)
-        REDasm::log("Found " + std::to_string(c) + " signature(s)");
-    else
-        REDasm::log("No signatures found");
 
+    engine.apply();
     return true;
 }
 
-void DisassemblerBase::computeBasicBlocks(document_x_lock &lock, const ListingItem *functionitem)
-{
-    REDasm::status("Computing basic blocks @ " + REDasm::hex(functionitem->address));
-    auto g = std::make_unique<Graphing::FunctionGraph>(this);
-
-    if(!g->build(functionitem))
-        return;
-
-    lock->functions().graph(functionitem, g.release());
-}
-
 } // namespace REDasm
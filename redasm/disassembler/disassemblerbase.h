@@ -19,6 +19,7 @@ class DisassemblerBase: public DisassemblerAPI
         const ListingDocument& document() const override;
         ListingDocument& document() override;
         ReferenceTable* references() override;
+        CallGraph* callGraph() override;
         ReferenceVector getReferences(address_t address) const override;
         ReferenceSet getTargets(address_t address) const override;
         ListingItems getCalls(address_t address) override;
@@ -46,7 +47,6 @@ class DisassemblerBase: public DisassemblerAPI
         bool loadSignature(const std::string& signame) override;
 
    private:
-        void computeBasicBlocks(document_x_lock &lock, const ListingItem *functionitem);
         template<typename T> std::string readStringT(address_t address, u64 len, std::function<bool(T, std::string&)> fill) const;
         template<typename T> u64 locationIsStringT(address_t address, std::function<bool(T)> isp, std::function<bool(T)> isa) const;
 
@@ -54,6 +54,7 @@ class DisassemblerBase: public DisassemblerAPI
         std::unique_ptr<AssemblerPlugin> m_assembler;
         std::unique_ptr<LoaderPlugin> m_loader;
         ReferenceTable m_referencetable;
+        CallGraph m_callgraph;
 };
 
 template<typename T> std::string DisassemblerBase::readStringT(address_t address, u64 len, std::function<bool(T, std::string&)> fill) const
@@ -445,14 +445,16 @@ ListingItem* ListingDocumentType::push(address_t address, size_t type, size_t in
             m_pendingautocomments.erase(it);
         }
     }
-    else if(type == ListingItem::FunctionItem)
-        m_functions.insert(item.get());
 
     auto it = ContainerType::find(item);
 
     if((it != this->end()) && (((*it)->address == address) && ((*it)->type == type)))
         return it->get();
 
+    if(type == ListingItem::FunctionItem)
+        m_functions.insert(item.get());
+
+    m_functions.invalidate(address);
     it = ContainerType::insert(std::move(item));
     ListingDocumentChanged ldc(it->get(), std::distance(this->begin(), it), ListingDocumentChanged::Inserted);
     changed(&ldc);
@@ -473,6 +475,7 @@ void ListingDocumentType::pop(address_t address, size_t type)
         if(type == ListingItem::FunctionItem)
             m_functions.erase(it->get());
 
+        m_functions.invalidate(address);
         this->erase(it);
         it = ContainerType::find(item, ListingItemPtrFinder());
     }
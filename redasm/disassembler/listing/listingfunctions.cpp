@@ -5,42 +5,191 @@ namespace REDasm {
 
 ListingFunctions::ListingFunctions(): ListingItemConstContainer() { }
 
-ListingFunctions::~ListingFunctions()
-{
-    for(const auto& item : m_graphs)
-        delete item.second;
-}
-
 const ListingItem *ListingFunctions::functionFromIndex(size_t idx) const
 {
-    auto it = std::find_if(m_graphs.begin(), m_graphs.end(), [idx](const FunctionGraphItem& item) -> bool {
-        return item.second->containsItem(idx);
-    });
+    auto it = m_index.find(idx);
 
-    if(it == m_graphs.end())
+    if(it == m_index.end())
         return nullptr;
 
-    return it->first;
+    return it->second.value;
+}
+
+void ListingFunctions::invalidate(address_t address)
+{
+    if(!m_blocks.empty())
+        m_dirty.insert(address);
 }
 
-void ListingFunctions::invalidateGraphs() { m_graphs.clear(); }
-const Graphing::FunctionGraph *ListingFunctions::graph(const ListingItem *item) const { auto it = m_graphs.find(item); return (it != m_graphs.end()) ? it->second : nullptr; }
-Graphing::FunctionGraph *ListingFunctions::graph(const ListingItem *item) { return const_cast<Graphing::FunctionGraph*>(static_cast<const ListingFunctions*>(this)->graph(item)); }
+void ListingFunctions::invalidateGraphs()
+{
+    this->clearCache();
+    m_blocks.clear();
+    m_index.clear();
+    m_dirty.clear();
+}
 
-void ListingFunctions::graph(const ListingItem *item, Graphing::FunctionGraph* fb)
+std::deque<const ListingItem *> ListingFunctions::dirtyFunctions(const ListingDocumentType *document)
 {
-    auto it = m_graphs.find(item);
+    if(!m_dirty.empty())
+    {
+        this->clearCache(); // Cached graphs may refer to stale indices, they will be rebuilt on demand
+
+        for(auto it = m_blocks.begin(); it != m_blocks.end(); ) // Move clean blocks to the current listing indices
+        {
+            if(it->second->rebase())
+            {
+                it++;
+                continue;
+            }
+
+            it = m_blocks.erase(it);
+        }
+
+        this->reindex();
+        std::unordered_set<const ListingItem*> dirty;
+
+        for(address_t address : m_dirty)
+        {
+            auto it = std::lower_bound(document->begin(), document->end(), address, [](const ListingItemPtr& item, address_t address) -> bool {
+                return item->address < address;
+            });
+
+            size_t idx = std::distance(document->begin(), it);
+            const ListingItem* functionitem = idx ? this->functionFromIndex(idx - 1) : nullptr; // The previous block may grow
+
+            if(functionitem)
+                dirty.insert(functionitem);
+
+            for( ; (it != document->end()) && ((*it)->address == address); it++, idx++)
+            {
+                functionitem = (*it)->is(ListingItem::FunctionItem) ? it->get() : this->functionFromIndex(idx);
 
-    if(it != m_graphs.end())
-        delete it->second;
+                if(functionitem)
+                    dirty.insert(functionitem);
+            }
+        }
 
-    m_graphs[item] = fb;
+        for(const ListingItem* functionitem : dirty)
+            this->eraseGraph(functionitem);
+
+        m_dirty.clear();
+    }
+
+    std::deque<const ListingItem*> functions;
+
+    for(const ListingItem* item : *this)
+    {
+        if(m_blocks.find(item) == m_blocks.end())
+            functions.push_back(item);
+    }
+
+    return functions;
+}
+
+std::shared_ptr<const Graphing::FunctionGraph> ListingFunctions::graph(const ListingItem *item) const { return this->cachedGraph(item); }
+ListingFunctions::FunctionGraphPtr ListingFunctions::graph(const ListingItem *item) { return this->cachedGraph(item); }
+
+void ListingFunctions::blocks(const ListingItem *item, const FunctionGraphPtr &blocks)
+{
+    this->eraseGraph(item);
+    m_blocks[item] = blocks;
+    this->indexGraph(item, blocks.get());
 }
 
 void ListingFunctions::erase(const ListingItem *item)
 {
-    m_graphs.erase(item);
+    this->eraseGraph(item);
     ListingItemConstContainer::erase(item);
 }
 
+void ListingFunctions::eraseGraph(const ListingItem *item)
+{
+    this->uncache(item);
+    auto it = m_blocks.find(item);
+
+    if(it == m_blocks.end())
+        return;
+
+    this->unindexGraph(item, it->second.get());
+    m_blocks.erase(it);
+}
+
+void ListingFunctions::reindex()
+{
+    m_index.clear();
+
+    for(const auto& item : m_blocks)
+        this->indexGraph(item.first, item.second.get());
+}
+
+ListingFunctions::FunctionGraphPtr ListingFunctions::cachedGraph(const ListingItem *item) const
+{
+    std::lock_guard<std::mutex> lock(m_cachemutex);
+    auto it = m_cache.find(item);
+
+    if(it != m_cache.end())
+    {
+        m_lru.splice(m_lru.begin(), m_lru, it->second.second);
+        return it->second.first;
+    }
+
+    auto bit = m_blocks.find(item);
+
+    if(bit == m_blocks.end())
+        return nullptr;
+
+    auto g = std::make_shared<Graphing::FunctionGraph>(*bit->second); // Reuse boundaries, only edges are missing
+    g->connectBasicBlocks();
+
+    if(m_cache.size() >= FUNCTION_GRAPH_CACHE_SIZE) // Evicted graphs stay alive while someone holds them
+    {
+        m_cache.erase(m_lru.back());
+        m_lru.pop_back();
+    }
+
+    m_lru.push_front(item);
+    m_cache[item] = std::make_pair(g, m_lru.begin());
+    return g;
+}
+
+void ListingFunctions::uncache(const ListingItem *item) const
+{
+    std::lock_guard<std::mutex> lock(m_cachemutex);
+    auto it = m_cache.find(item);
+
+    if(it == m_cache.end())
+        return;
+
+    m_lru.erase(it->second.second);
+    m_cache.erase(it);
+}
+
+void ListingFunctions::clearCache() const
+{
+    std::lock_guard<std::mutex> lock(m_cachemutex);
+    m_cache.clear();
+    m_lru.clear();
+}
+
+void ListingFunctions::indexGraph(const ListingItem *item, const Graphing::FunctionGraph *graph)
+{
+    for(const Graphing::Node& n : graph->nodes())
+    {
+        const Graphing::FunctionBasicBlock* fbb = graph->data(n);
+        m_index.insert(fbb->startidx, fbb->endidx, item);
+    }
+}
+
+void ListingFunctions::unindexGraph(const ListingItem *item, const Graphing::FunctionGraph *graph)
+{
+    for(const Graphing::Node& n : graph->nodes())
+    {
+        auto it = m_index.find(graph->data(n)->startidx);
+
+        if((it != m_index.end()) && (it->second.value == item)) // Blocks shared with another function aren't indexed twice
+            m_index.erase(it);
+    }
+}
+
 } // namespace REDasm
@@ -1,10 +1,18 @@
 #pragma once
 
+#define FUNCTION_GRAPH_CACHE_SIZE 64
+
 #include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <list>
 #include "listingitem.h"
+#include "../../support/containers/interval_map.h"
 
 namespace REDasm {
 
+class ListingDocumentType;
+
 namespace Graphing {
 class FunctionGraph;
 }
@@ -12,21 +20,39 @@ class FunctionGraph;
 class ListingFunctions: public ListingItemConstContainer
 {
     private:
-        typedef std::pair< const ListingItem*, Graphing::FunctionGraph* > FunctionGraphItem;
-        typedef std::unordered_map< const ListingItem*, Graphing::FunctionGraph* > FunctionGraphs;
+        typedef std::shared_ptr<Graphing::FunctionGraph> FunctionGraphPtr;
+        typedef std::unordered_map< const ListingItem*, FunctionGraphPtr > FunctionGraphs;
+        typedef interval_map< size_t, const ListingItem* > FunctionIndex;
+        typedef std::list<const ListingItem*> GraphLRU;
+        typedef std::unordered_map< const ListingItem*, std::pair<FunctionGraphPtr, GraphLRU::iterator> > GraphCache;
 
     public:
         ListingFunctions();
-        ~ListingFunctions();
         const ListingItem* functionFromIndex(size_t idx) const;
-        const Graphing::FunctionGraph* graph(const ListingItem* item) const;
-        Graphing::FunctionGraph* graph(const ListingItem* item);
-        void graph(const ListingItem* item, Graphing::FunctionGraph* graph);
+        std::shared_ptr<const Graphing::FunctionGraph> graph(const ListingItem* item) const; // Built on demand, eviction doesn't invalidate it
+        FunctionGraphPtr graph(const ListingItem* item);
+        void blocks(const ListingItem* item, const FunctionGraphPtr& blocks);
         void erase(const ListingItem* item);
+        void invalidate(address_t address);
         void invalidateGraphs();
+        std::deque<const ListingItem*> dirtyFunctions(const ListingDocumentType* document);
+
+    private:
+        void indexGraph(const ListingItem* item, const Graphing::FunctionGraph* graph);
+        void unindexGraph(const ListingItem* item, const Graphing::FunctionGraph* graph);
+        void eraseGraph(const ListingItem* item);
+        void reindex();
+        FunctionGraphPtr cachedGraph(const ListingItem* item) const;
+        void uncache(const ListingItem* item) const;
+        void clearCache() const;
 
     private:
-        FunctionGraphs m_graphs;
+        FunctionGraphs m_blocks; // Block boundaries only
+        FunctionIndex m_index;
+        mutable GraphCache m_cache;
+        mutable GraphLRU m_lru;
+        mutable std::mutex m_cachemutex;
+        std::set<address_t> m_dirty;
 };
 
 } // namespace REDasm
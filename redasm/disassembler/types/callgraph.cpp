@@ -0,0 +1,371 @@
+#include "callgraph.h"
+#include "../disassemblerapi.h"
+#include "../listing/listingdocument.h"
+#include <stack>
+
+namespace REDasm {
+
+CallGraph::CallGraph(DisassemblerAPI *disassembler): m_disassembler(disassembler) { }
+
+void CallGraph::pushCallSite(address_t callsite)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_callsites.insert(callsite).second)
+        m_pending.insert(callsite);
+}
+
+void CallGraph::pushTarget(address_t, address_t callsite)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_callsites.count(callsite) && !m_orphans.count(callsite))
+        m_pending.insert(callsite); // Edges only grow: resolving it again adds the new callee
+}
+
+void CallGraph::popTarget(address_t, address_t callsite)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_owners.find(callsite);
+
+    if(it != m_owners.end()) // Other call sites may reach the same callee: rebuild the whole function
+        this->requeue(it->second);
+}
+
+void CallGraph::invalidate(const ReferenceSet &functions)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(address_t function : functions)
+    {
+        this->requeue(function);
+
+        // A new function may have been split from the one before it: take back its call sites too
+        for(auto it = m_owners.lower_bound(function); (it != m_owners.end()) && (it->second <= function); )
+        {
+            address_t owner = (it++)->second;
+
+            if(owner < function)
+            {
+                this->requeue(owner);
+                it = m_owners.lower_bound(function);
+            }
+        }
+    }
+
+    m_pending.insert(m_orphans.begin(), m_orphans.end());
+    m_orphans.clear();
+}
+
+void CallGraph::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_callsites.clear();
+    m_pending.clear();
+    m_orphans.clear();
+    m_owners.clear();
+    m_sites.clear();
+    m_callees.clear();
+    m_callers.clear();
+}
+
+bool CallGraph::isCallSite(address_t address) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_callsites.find(address) != m_callsites.end();
+}
+
+ReferenceSet CallGraph::callSites(address_t function)
+{
+    this->update();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sites.find(function);
+    return (it != m_sites.end()) ? it->second : ReferenceSet();
+}
+
+ReferenceSet CallGraph::callees(address_t function)
+{
+    this->update();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_callees.find(function);
+    return (it != m_callees.end()) ? it->second : ReferenceSet();
+}
+
+ReferenceSet CallGraph::callers(address_t function)
+{
+    this->update();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_callers.find(function);
+    return (it != m_callers.end()) ? it->second : ReferenceSet();
+}
+
+ReferenceSet CallGraph::callers(address_t function, size_t depth)
+{
+    this->update();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ReferenceSet result;
+    std::deque< std::pair<address_t, size_t> > pending = { { function, 0 } };
+
+    while(!pending.empty())
+    {
+        auto current = pending.front();
+        pending.pop_front();
+
+        if(current.second >= depth)
+            continue;
+
+        auto it = m_callers.find(current.first);
+
+        if(it == m_callers.end())
+            continue;
+
+        for(address_t caller : it->second)
+        {
+            if(result.insert(caller).second)
+                pending.push_back({ caller, current.second + 1 });
+        }
+    }
+
+    return result;
+}
+
+bool CallGraph::reachable(address_t fromfunction, address_t tofunction)
+{
+    this->update();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::unordered_set<address_t> visited = { fromfunction };
+    std::stack<address_t> pending;
+    pending.push(fromfunction);
+
+    while(!pending.empty())
+    {
+        address_t function = pending.top();
+        pending.pop();
+
+        if(function == tofunction)
+            return true;
+
+        auto it = m_callees.find(function);
+
+        if(it == m_callees.end())
+            continue;
+
+        for(address_t callee : it->second)
+        {
+            if(visited.insert(callee).second)
+                pending.push(callee);
+        }
+    }
+
+    return false;
+}
+
+CallGraph::Components CallGraph::components()
+{
+    this->update();
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    struct Frame { address_t function; ReferenceSet::const_iterator it, end; };
+
+    const ReferenceSet nocallees;
+    std::unordered_map<address_t, size_t> index, lowlink;
+    std::unordered_set<address_t> onstack;
+    std::stack<address_t> stack;
+    std::stack<Frame> frames;
+    Components components;
+    size_t counter = 0;
+
+    auto visit = [&](address_t function) {
+        index[function] = lowlink[function] = counter++;
+        stack.push(function);
+        onstack.insert(function);
+
+        auto it = m_callees.find(function);
+        const ReferenceSet& callees = (it != m_callees.end()) ? it->second : nocallees;
+        frames.push({ function, callees.begin(), callees.end() });
+    };
+
+    ReferenceSet functions; // Visit in address order, the result is stable across runs
+
+    for(const auto& item : m_callees)
+        functions.insert(item.first);
+
+    for(const auto& item : m_callers)
+        functions.insert(item.first);
+
+    for(address_t function : functions)
+    {
+        if(index.find(function) != index.end())
+            continue;
+
+        visit(function);
+
+        while(!frames.empty())
+        {
+            Frame& frame = frames.top();
+
+            if(frame.it != frame.end)
+            {
+                address_t callee = *frame.it++;
+
+                if(index.find(callee) == index.end())
+                    visit(callee);
+                else if(onstack.find(callee) != onstack.end())
+                    lowlink[frame.function] = std::min(lowlink[frame.function], index[callee]);
+
+                continue;
+            }
+
+            address_t current = frame.function;
+            frames.pop();
+
+            if(lowlink[current] == index[current])
+            {
+                ReferenceSet component;
+                address_t member = 0;
+
+                do
+                {
+                    member = stack.top();
+                    stack.pop();
+                    onstack.erase(member);
+                    component.insert(member);
+                }
+                while(member != current);
+
+                components.push_back(std::move(component));
+            }
+
+            if(!frames.empty())
+            {
+                address_t caller = frames.top().function;
+                lowlink[caller] = std::min(lowlink[caller], lowlink[current]);
+            }
+        }
+    }
+
+    return components;
+}
+
+void CallGraph::update()
+{
+    struct Resolved { address_t callsite, function; ReferenceSet callees; };
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while(!m_pending.empty())
+    {
+        AddressSet pending;
+        pending.swap(m_pending);
+        lock.unlock(); // Document and reference table have their own locks
+
+        std::deque<Resolved> resolved;
+        std::deque<address_t> orphans;
+
+        for(address_t callsite : pending)
+        {
+            Resolved r = { callsite, 0, ReferenceSet() };
+
+            if(!this->owner(callsite, &r.function))
+            {
+                orphans.push_back(callsite);
+                continue;
+            }
+
+            for(address_t target : m_disassembler->getTargets(callsite))
+                r.callees.insert(this->resolveCallee(target));
+
+            resolved.push_back(std::move(r));
+        }
+
+        lock.lock();
+
+        for(const Resolved& r : resolved)
+        {
+            if(!m_callsites.count(r.callsite)) // Cleared meanwhile
+                continue;
+
+            auto it = m_owners.find(r.callsite);
+
+            if((it != m_owners.end()) && (it->second != r.function))
+                this->requeue(it->second); // Moved to another function: its old owner is stale
+
+            m_owners[r.callsite] = r.function;
+            m_sites[r.function].insert(r.callsite);
+
+            for(address_t callee : r.callees)
+            {
+                m_callees[r.function].insert(callee);
+                m_callers[callee].insert(r.function);
+            }
+        }
+
+        for(address_t callsite : orphans)
+        {
+            if(m_callsites.count(callsite))
+                m_orphans.insert(callsite);
+        }
+    }
+}
+
+void CallGraph::requeue(address_t function)
+{
+    auto it = m_callees.find(function);
+
+    if(it != m_callees.end())
+    {
+        for(address_t callee : it->second)
+        {
+            auto cit = m_callers.find(callee);
+
+            if(cit == m_callers.end())
+                continue;
+
+            cit->second.erase(function);
+
+            if(cit->second.empty())
+                m_callers.erase(cit);
+        }
+
+        m_callees.erase(it);
+    }
+
+    auto sit = m_sites.find(function);
+
+    if(sit == m_sites.end())
+        return;
+
+    for(address_t callsite : sit->second)
+    {
+        m_owners.erase(callsite);
+        m_pending.insert(callsite);
+    }
+
+    m_sites.erase(sit);
+}
+
+address_t CallGraph::resolveCallee(address_t target) const
+{
+    const Symbol* symbol = m_disassembler->document()->symbol(target);
+
+    if(!symbol || !symbol->is(SymbolType::Pointer) || symbol->isImport())
+        return target;
+
+    const Symbol* ptrsymbol = m_disassembler->dereferenceSymbol(symbol);
+    return ptrsymbol ? ptrsymbol->address : target;
+}
+
+bool CallGraph::owner(address_t callsite, address_t *function) const
+{
+    const ListingItem* item = m_disassembler->document()->functionStart(callsite);
+
+    if(!item)
+        return false;
+
+    *function = item->address;
+    return true;
+}
+
+} // namespace REDasm
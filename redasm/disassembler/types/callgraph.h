@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unordered_set>
+#include <mutex>
+#include <map>
+#include "referencetable.h"
+
+namespace REDasm {
+
+class DisassemblerAPI;
+
+class CallGraph // Call sites are queued as they are decoded, edges are resolved on the next query
+{
+    private:
+        typedef std::unordered_map<address_t, ReferenceSet> AdjacencyMap;
+        typedef std::unordered_set<address_t> AddressSet;
+
+    public:
+        typedef std::deque<ReferenceSet> Components;
+
+    public:
+        CallGraph(DisassemblerAPI* disassembler);
+        void pushCallSite(address_t callsite);
+        void pushTarget(address_t target, address_t callsite);
+        void popTarget(address_t target, address_t callsite);
+        void invalidate(const ReferenceSet& functions); // Boundaries of these functions have changed
+        void clear();
+        bool isCallSite(address_t address) const;
+        ReferenceSet callSites(address_t function);
+        ReferenceSet callees(address_t function);
+        ReferenceSet callers(address_t function);
+        ReferenceSet callers(address_t function, size_t depth);
+        bool reachable(address_t fromfunction, address_t tofunction);
+        Components components();
+
+    private:
+        void update();
+        void requeue(address_t function);
+        address_t resolveCallee(address_t target) const;
+        bool owner(address_t callsite, address_t* function) const;
+
+    private:
+        DisassemblerAPI* m_disassembler;
+        mutable std::mutex m_mutex;      // Never held while the document or the references are read
+        AddressSet m_callsites;
+        AddressSet m_pending;            // Edges to (re)resolve
+        AddressSet m_orphans;            // No function owns them yet, retried when boundaries change
+        std::map<address_t, address_t> m_owners; // Call site -> function, sorted by call site
+        AdjacencyMap m_sites, m_callees, m_callers;
+};
+
+} // namespace REDasm
@@ -11,7 +11,7 @@ template<typename T> class EmulatorALU: public EmulatorBase<T>
         enum { CarryFlag = 0 };
 
     public:
-        EmulatorALU(DisassemblerAPI* disassembler);
+        EmulatorALU(DisassemblerAPI* disassembler, const RegisterFileDescriptor& registerfile = { 0 });
         bool displacement(const Operand* op, u64* value) override;
         bool hasCarry() const;
 
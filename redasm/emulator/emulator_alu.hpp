@@ -7,7 +7,7 @@
 
 namespace REDasm {
 
-template<typename T> EmulatorALU<T>::EmulatorALU(DisassemblerAPI *disassembler): EmulatorBase<T>(disassembler) { }
+template<typename T> EmulatorALU<T>::EmulatorALU(DisassemblerAPI *disassembler, const RegisterFileDescriptor &registerfile): EmulatorBase<T>(disassembler, registerfile) { }
 
 template<typename T> bool EmulatorALU<T>::displacement(const Operand *op, u64 *value)
 {
@@ -1,9 +1,8 @@
 #pragma once
 
-#include <unordered_map>
-#include <unordered_set>
 #include <type_traits>
 #include "../plugins/emulator.h"
+#include "emulator_registers.h"
 #include "../redasm.h"
 
 namespace REDasm {
@@ -11,15 +10,26 @@ namespace REDasm {
 template<typename T> class EmulatorBase: public Emulator
 {
     private:
-        enum { ErrorFlag = 0xFF };
+        enum { ErrorFlag = 63 }; // Flags are bit indices, architecture flags start from 0
 
     private:
         typedef typename std::make_signed<T>::type ST;
-        typedef std::unordered_map<T, T> MapT;
-        typedef std::unordered_set<T> Flags;
+        typedef EmulatorRegisters<T> Registers;
+        typedef std::shared_ptr<Registers> RegistersPtr;
 
     public:
-        EmulatorBase(DisassemblerAPI* disassembler);
+        class Snapshot
+        {
+            private:
+                EmulatorMemory::Snapshot m_memory;
+                RegistersPtr m_registers;
+                u64 m_flags;
+                T m_sp;
+                friend class EmulatorBase<T>;
+        };
+
+    public:
+        EmulatorBase(DisassemblerAPI* disassembler, const RegisterFileDescriptor& registerfile = { 0 });
         void emulate(const InstructionPtr& instruction) override;
         bool readOp(const Operand *op, T* value);
 
@@ -34,8 +44,15 @@ template<typename T> class EmulatorBase: public Emulator
         bool writeMem(T address, T value, T size = sizeof(T));
         bool readMem(T address, T* value, T size = sizeof(T));
 
+    private:
+        template<typename U> bool readMemT(T address, T* value);
+        Registers& registers();
+
     public:
         bool hasError() const override;
+        Emulator* fork() const override;
+        Snapshot snapshot() const;              // O(1), registers and memory are copied on write
+        void restore(const Snapshot& snapshot); // O(1)
         void reset(bool resetmemory = false);
         void unhandled(const InstructionPtr& instruction) const;
         void fail();
@@ -44,8 +61,8 @@ template<typename T> class EmulatorBase: public Emulator
         bool displacementT(const DisplacementOperand& dispop, T* value);
 
     private:
-        MapT m_registers;
-        Flags m_flags;
+        RegistersPtr m_registers;
+        u64 m_flags;
         T m_sp;
 };
 
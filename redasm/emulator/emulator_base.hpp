@@ -1,10 +1,11 @@
 #pragma once
 
 #include "emulator_base.h"
+#include "../plugins/assembler/assembler.h"
 
 namespace REDasm {
 
-template<typename T> EmulatorBase<T>::EmulatorBase(DisassemblerAPI* disassembler): Emulator(disassembler), m_sp(0) { }
+template<typename T> EmulatorBase<T>::EmulatorBase(DisassemblerAPI* disassembler, const RegisterFileDescriptor& registerfile): Emulator(disassembler), m_registers(std::make_shared<Registers>(registerfile)), m_flags(0), m_sp(0) { }
 
 template<typename T> void EmulatorBase<T>::emulate(const InstructionPtr& instruction)
 {
@@ -75,24 +76,18 @@ template<typename T> void EmulatorBase<T>::writeOp(const Operand *op, T value)
 
 template<typename T> void EmulatorBase<T>::flag(T flag, bool set)
 {
+    if(flag >= 64)
+        return;
+
     if(set)
-        m_flags.insert(flag);
+        m_flags |= (static_cast<u64>(1) << flag);
     else
-        m_flags.erase(flag);
+        m_flags &= ~(static_cast<u64>(1) << flag);
 }
 
-template<typename T> bool EmulatorBase<T>::flag(T flag) const { return m_flags.find(flag) != m_flags.end(); }
-template<typename T> void EmulatorBase<T>::writeReg(T r, T value) { m_registers[r] = value; }
-
-template<typename T> T EmulatorBase<T>::readReg(T r) const
-{
-    auto it = m_registers.find(r);
-
-    if(it != m_registers.end())
-        return it->second;
-
-    return 0;
-}
+template<typename T> bool EmulatorBase<T>::flag(T flag) const { return (flag < 64) && (m_flags & (static_cast<u64>(1) << flag)); }
+template<typename T> void EmulatorBase<T>::writeReg(T r, T value) { this->registers().write(r, value); }
+template<typename T> T EmulatorBase<T>::readReg(T r) const { return m_registers->read(r); }
 
 template<typename T> void EmulatorBase<T>::changeReg(const Operand *op, ST amount)
 {
@@ -126,61 +121,102 @@ template<typename T> void EmulatorBase<T>::changeSP(ST amount)
 
 template<typename T> bool EmulatorBase<T>::writeMem(T address, T value, T size)
 {
-    BufferView memoryview = this->getMemory(address);
-
-    if(memoryview.eob())
-        return false;
+    bool res = false;
 
     if(size == sizeof(u8))
-        memoryview = static_cast<u8>(value);
+        res = m_memory.write(address, static_cast<u8>(value));
     else if(size == sizeof(u16))
-        memoryview = static_cast<u16>(value);
+        res = m_memory.write(address, static_cast<u16>(value));
     else if(size == sizeof(u32))
-        memoryview = static_cast<u32>(value);
+        res = m_memory.write(address, static_cast<u32>(value));
     else if(size == sizeof(u64))
-        memoryview = static_cast<u64>(value);
+        res = m_memory.write(address, static_cast<u64>(value));
     else
     {
         REDasm::problem("WriteMemory: Invalid size (" + std::to_string(size) + ")");
         this->fail();
+        return true;
     }
 
-    return true;
+    return res;
 }
 
 template<typename T> bool EmulatorBase<T>::readMem(T address, T* value, T size)
 {
-    BufferView memoryview = this->getMemory(address);
-
-    if(memoryview.eob())
-        return false;
+    bool res = false;
 
     if(size == sizeof(u8))
-        *value = static_cast<u8>(memoryview);
+        res = this->readMemT<u8>(address, value);
     else if(size == sizeof(u16))
-        *value = static_cast<T>(static_cast<u16>(memoryview));
+        res = this->readMemT<u16>(address, value);
     else if(size == sizeof(u32))
-        *value = static_cast<T>(static_cast<u32>(memoryview));
+        res = this->readMemT<u32>(address, value);
     else if(size == sizeof(u64))
-        *value = static_cast<T>(static_cast<u64>(memoryview));
+        res = this->readMemT<u64>(address, value);
     else
     {
         REDasm::problem("ReadMemory: Invalid size (" + std::to_string(size) + ")");
         this->fail();
+        return true;
     }
 
+    return res;
+}
+
+template<typename T> template<typename U> bool EmulatorBase<T>::readMemT(T address, T* value)
+{
+    U uvalue = 0;
+
+    if(!m_memory.read(address, &uvalue))
+        return false;
+
+    *value = static_cast<T>(uvalue);
     return true;
 }
 
 template<typename T> bool EmulatorBase<T>::hasError() const { return flag(ErrorFlag); }
 
+template<typename T> Emulator* EmulatorBase<T>::fork() const
+{
+    Emulator* emulator = m_disassembler->assembler()->createEmulator(m_disassembler);
+    auto* forked = dynamic_cast<EmulatorBase<T>*>(emulator);
+
+    if(!forked)
+    {
+        delete emulator;
+        return nullptr;
+    }
+
+    forked->restore(this->snapshot());
+    forked->m_currentinstruction = m_currentinstruction;
+    return forked;
+}
+
+template<typename T> typename EmulatorBase<T>::Snapshot EmulatorBase<T>::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.m_memory = m_memory.snapshot();
+    snapshot.m_registers = m_registers;
+    snapshot.m_flags = m_flags;
+    snapshot.m_sp = m_sp;
+    return snapshot;
+}
+
+template<typename T> void EmulatorBase<T>::restore(const Snapshot &snapshot)
+{
+    m_memory.restore(snapshot.m_memory);
+    m_registers = snapshot.m_registers;
+    m_flags = snapshot.m_flags;
+    m_sp = snapshot.m_sp;
+}
+
 template<typename T> void EmulatorBase<T>::reset(bool resetmemory)
 {
     if(resetmemory)
-        this->remap();
+        m_memory.discard();
 
-    m_registers.clear();
-    m_flags.clear();
+    this->registers().clear();
+    m_flags = 0;
 }
 
 template<typename T> void EmulatorBase<T>::unhandled(const InstructionPtr &instruction) const
@@ -190,7 +226,7 @@ template<typename T> void EmulatorBase<T>::unhandled(const InstructionPtr &instr
 
 template<typename T> void EmulatorBase<T>::fail()
 {
-    this->flag(ErrorFlag);
+    this->flag(ErrorFlag, true);
 
     if(m_currentinstruction)
     {
@@ -201,6 +237,14 @@ template<typename T> void EmulatorBase<T>::fail()
         REDasm::problem("WARNING: Emulator in FAIL state");
 }
 
+template<typename T> typename EmulatorBase<T>::Registers& EmulatorBase<T>::registers()
+{
+    if(m_registers.use_count() > 1) // Shared with a snapshot
+        m_registers = std::make_shared<Registers>(*m_registers);
+
+    return *m_registers;
+}
+
 template<typename T> bool EmulatorBase<T>::displacementT(const DisplacementOperand &dispop, T* value)
 {
     T address = 0;
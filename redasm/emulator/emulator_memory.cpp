@@ -0,0 +1,383 @@
+#include "emulator_memory.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#define EMULATOR_NO_PAGE std::numeric_limits<u64>::max()
+
+namespace REDasm {
+
+namespace {
+
+const u8 ZERO_PAGE[EMULATOR_PAGE_SIZE] = { }; // Shared by every untouched BSS page
+
+} // namespace
+
+EmulatorMemory::EmulatorMemory(): m_regions(std::make_shared<std::vector<Region> >()), m_tlbentry(nullptr), m_tlbindex(EMULATOR_NO_PAGE), m_owner(EmulatorMemory::nextOwner()), m_tlbwritable(false) { }
+bool EmulatorMemory::empty() const { return m_regions->empty(); }
+size_t EmulatorMemory::pages() const { return m_directory ? m_directory->pages : 0; }
+
+void EmulatorMemory::clear()
+{
+    m_regions = std::make_shared<std::vector<Region> >();
+    this->discard();
+}
+
+void EmulatorMemory::discard()
+{
+    m_directory.reset();
+    this->flushTLB();
+}
+
+bool EmulatorMemory::map(address_t address, u64 size, const u8 *data, u64 datasize)
+{
+    if(!size || ((address + size) < address))
+        return false;
+
+    Region r = { address, address + size, data, data ? std::min(datasize, size) : 0 };
+    auto regions = std::make_shared<std::vector<Region> >(*m_regions); // Snapshots keep the old layout
+    auto it = std::lower_bound(regions->begin(), regions->end(), r, [](const Region& r1, const Region& r2) -> bool { return r1.address < r2.address; });
+
+    if((it != regions->end()) && (it->address < r.endaddress))
+        return false;
+
+    if((it != regions->begin()) && (std::prev(it)->endaddress > r.address))
+        return false;
+
+    regions->insert(it, r);
+    m_regions = regions;
+    this->flushTLB();
+
+    if(!m_directory)
+        return true;
+
+    // Only the first and the last page can be shared with an older region and hold written data,
+    // every other entry is resolved again on the next access
+    u64 firstpage = address >> EMULATOR_PAGE_BITS, lastpage = (r.endaddress - 1) >> EMULATOR_PAGE_BITS;
+
+    auto invalidate = [&](u64 tableindex, PageTablePtr& tableptr) {
+        PageTable* table = this->ownTable(tableptr);
+
+        for(u64 i = 0; i < EMULATOR_TABLE_SIZE; i++)
+        {
+            PageEntry& entry = table->entries[i];
+            u64 pageindex = (tableindex << EMULATOR_TABLE_BITS) | i;
+
+            if(!entry.page)
+            {
+                entry.data = nullptr;
+                entry.flags = PageFlags::None;
+                continue;
+            }
+
+            if((pageindex != firstpage) && (pageindex != lastpage))
+                continue;
+
+            address_t pageaddress = pageindex << EMULATOR_PAGE_BITS;
+            address_t start = std::max(address, pageaddress), last = std::min(r.endaddress - 1, pageaddress + EMULATOR_PAGE_MASK);
+            u64 roffset = start - address;
+            u8* pagedata = this->writablePage(pageindex, &entry);
+
+            if(roffset < r.size)
+                std::memcpy(pagedata + (start - pageaddress), r.data + roffset, std::min(last - start + 1, r.size - roffset));
+
+            entry.flags |= PageFlags::Partial;
+        }
+    };
+
+    Directory* directory = this->ownDirectory();
+
+    for(u64 i = 0; i < directory->lowtables.size(); i++)
+    {
+        if(directory->lowtables[i])
+            invalidate(i, directory->lowtables[i]);
+    }
+
+    for(auto& item : directory->hightables)
+        invalidate(item.first, item.second);
+
+    this->flushTLB();
+    return true;
+}
+
+bool EmulatorMemory::isMapped(address_t address) const { return this->region(address) != nullptr; }
+
+EmulatorMemory::Snapshot EmulatorMemory::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.m_regions = m_regions;
+    snapshot.m_directory = m_directory;
+
+    m_owner = EmulatorMemory::nextOwner(); // Everything is shared now
+    this->flushTLB();
+    return snapshot;
+}
+
+void EmulatorMemory::restore(const Snapshot &snapshot)
+{
+    m_regions = snapshot.m_regions ? snapshot.m_regions : std::make_shared<std::vector<Region> >();
+    m_directory = snapshot.m_directory;
+    m_owner = EmulatorMemory::nextOwner(); // The snapshot can be restored again
+    this->flushTLB();
+}
+
+EmulatorMemory::PageEntry *EmulatorMemory::lookupSlow(u64 pageindex) const
+{
+    PageTable* table = this->findTable(pageindex);
+    u64 entryindex = pageindex & EMULATOR_TABLE_MASK;
+
+    if(!table || !(table->entries[entryindex].flags & PageFlags::Resolved)) // Resolving modifies the table
+        table = this->ownTable(pageindex);
+
+    PageEntry* entry = &table->entries[entryindex];
+
+    if(!(entry->flags & PageFlags::Resolved))
+        this->resolve(pageindex, entry);
+
+    m_tlbindex = pageindex;
+    m_tlbentry = entry;
+    m_tlbwritable = (table->owner == m_owner);
+    return entry;
+}
+
+EmulatorMemory::PageTable *EmulatorMemory::findTable(u64 pageindex) const
+{
+    if(!m_directory)
+        return nullptr;
+
+    u64 tableindex = pageindex >> EMULATOR_TABLE_BITS;
+
+    if(tableindex < EMULATOR_LOW_TABLES)
+        return (tableindex < m_directory->lowtables.size()) ? m_directory->lowtables[tableindex].get() : nullptr;
+
+    auto it = m_directory->hightables.find(tableindex);
+    return (it != m_directory->hightables.end()) ? it->second.get() : nullptr;
+}
+
+EmulatorMemory::PageTable *EmulatorMemory::ownTable(u64 pageindex) const
+{
+    Directory* directory = this->ownDirectory();
+    u64 tableindex = pageindex >> EMULATOR_TABLE_BITS;
+
+    if(tableindex >= EMULATOR_LOW_TABLES)
+        return this->ownTable(directory->hightables[tableindex]);
+
+    if(directory->lowtables.empty())
+        directory->lowtables.resize(EMULATOR_LOW_TABLES);
+
+    return this->ownTable(directory->lowtables[tableindex]);
+}
+
+EmulatorMemory::PageTable *EmulatorMemory::ownTable(PageTablePtr &table) const
+{
+    if(!table)
+    {
+        table = std::make_shared<PageTable>();
+        table->owner = m_owner;
+
+        for(PageEntry& entry : table->entries)
+        {
+            entry.data = nullptr;
+            entry.flags = PageFlags::None;
+        }
+    }
+    else if(table->owner != m_owner)
+    {
+        table = std::make_shared<PageTable>(*table);
+        table->owner = m_owner;
+
+        for(PageEntry& entry : table->entries) // Pages are still shared
+            entry.flags &= ~PageFlags::Write;
+
+        this->flushTLB();
+    }
+
+    return table.get();
+}
+
+EmulatorMemory::Directory *EmulatorMemory::ownDirectory() const
+{
+    if(!m_directory)
+    {
+        m_directory = std::make_shared<Directory>();
+        m_directory->pages = 0;
+        m_directory->owner = m_owner;
+    }
+    else if(m_directory->owner != m_owner)
+    {
+        m_directory = std::make_shared<Directory>(*m_directory);
+        m_directory->owner = m_owner;
+    }
+
+    return m_directory.get();
+}
+
+bool EmulatorMemory::readSlow(address_t address, u8 *value, u64 size) const
+{
+    while(size)
+    {
+        const Region* r = this->region(address);
+
+        if(!r)
+            return false;
+
+        u64 offset = address & EMULATOR_PAGE_MASK;
+        u64 chunk = std::min(std::min(size, EMULATOR_PAGE_SIZE - offset), r->endaddress - address);
+        const PageEntry* entry = this->lookup(address >> EMULATOR_PAGE_BITS);
+
+        if(entry->page)
+            std::memcpy(value, entry->page->data + offset, chunk);
+        else
+        {
+            u64 roffset = address - r->address;
+            u64 backed = (roffset < r->size) ? std::min(chunk, r->size - roffset) : 0;
+
+            if(backed)
+                std::memcpy(value, r->data + roffset, backed);
+
+            std::memset(value + backed, 0, chunk - backed); // Lazy BSS
+        }
+
+        address += chunk;
+        value += chunk;
+        size -= chunk;
+    }
+
+    return true;
+}
+
+bool EmulatorMemory::writeSlow(address_t address, const u8 *value, u64 size)
+{
+    for(u64 pending = size, a = address; pending; ) // Check the whole range first, writes are all or nothing
+    {
+        const Region* r = this->region(a);
+
+        if(!r)
+            return false;
+
+        u64 chunk = std::min(pending, r->endaddress - a);
+        a += chunk;
+        pending -= chunk;
+    }
+
+    while(size)
+    {
+        u64 offset = address & EMULATOR_PAGE_MASK, pageindex = address >> EMULATOR_PAGE_BITS;
+        u64 chunk = std::min(size, EMULATOR_PAGE_SIZE - offset);
+        PageTable* table = this->ownTable(pageindex);
+        PageEntry* entry = &table->entries[pageindex & EMULATOR_TABLE_MASK];
+
+        if(!(entry->flags & PageFlags::Resolved))
+            this->resolve(pageindex, entry);
+
+        std::memcpy(this->writablePage(pageindex, entry) + offset, value, chunk);
+        address += chunk;
+        value += chunk;
+        size -= chunk;
+    }
+
+    return true;
+}
+
+const EmulatorMemory::Region *EmulatorMemory::region(address_t address) const
+{
+    auto it = std::upper_bound(m_regions->begin(), m_regions->end(), address, [](address_t a, const Region& r) -> bool { return a < r.address; });
+
+    if(it == m_regions->begin())
+        return nullptr;
+
+    it--;
+    return (address < it->endaddress) ? &(*it) : nullptr;
+}
+
+void EmulatorMemory::resolve(u64 pageindex, PageEntry *entry) const
+{
+    address_t pageaddress = pageindex << EMULATOR_PAGE_BITS, pagelast = pageaddress + EMULATOR_PAGE_MASK;
+    const Region* r = this->region(pageaddress);
+    entry->flags = PageFlags::Resolved;
+
+    if(!r || ((r->endaddress - 1) < pagelast)) // Not covered by a single region
+    {
+        auto it = std::upper_bound(m_regions->begin(), m_regions->end(), pageaddress, [](address_t a, const Region& r) -> bool { return a < r.address; });
+
+        if(r || ((it != m_regions->end()) && (it->address <= pagelast)))
+            entry->flags |= PageFlags::Read | PageFlags::Partial;
+
+        return;
+    }
+
+    u64 roffset = pageaddress - r->address;
+
+    if((roffset + EMULATOR_PAGE_SIZE) <= r->size)
+    {
+        entry->data = r->data + roffset;
+        entry->flags |= PageFlags::Read;
+    }
+    else if(roffset >= r->size)
+    {
+        entry->data = ZERO_PAGE;
+        entry->flags |= PageFlags::Read;
+    }
+    else
+        this->materialize(pageindex, entry); // File data ends inside this page
+}
+
+void EmulatorMemory::materialize(u64 pageindex, PageEntry *entry) const
+{
+    PagePtr page = std::make_shared<Page>();
+    std::memset(page->data, 0, EMULATOR_PAGE_SIZE);
+
+    address_t pageaddress = pageindex << EMULATOR_PAGE_BITS, pagelast = pageaddress + EMULATOR_PAGE_MASK;
+    auto it = std::upper_bound(m_regions->begin(), m_regions->end(), pageaddress, [](address_t a, const Region& r) -> bool { return a < r.address; });
+
+    if(it != m_regions->begin())
+        it--;
+
+    for( ; (it != m_regions->end()) && (it->address <= pagelast); it++) // A page can span more than one region
+    {
+        if(it->endaddress <= pageaddress)
+            continue;
+
+        address_t start = std::max(it->address, pageaddress), last = std::min(it->endaddress - 1, pagelast);
+        u64 roffset = start - it->address;
+
+        if(roffset < it->size)
+            std::memcpy(page->data + (start - pageaddress), it->data + roffset, std::min(last - start + 1, it->size - roffset));
+    }
+
+    entry->page = page;
+    entry->data = page->data;
+    entry->flags |= PageFlags::Read | PageFlags::Write;
+    this->ownDirectory()->pages++;
+}
+
+u8 *EmulatorMemory::writablePage(u64 pageindex, PageEntry *entry) const
+{
+    if(!entry->page)
+        this->materialize(pageindex, entry);
+    else if(!(entry->flags & PageFlags::Write))
+    {
+        if(entry->page.use_count() > 1) // Still referenced by a snapshot
+            entry->page = std::make_shared<Page>(*entry->page);
+
+        entry->data = entry->page->data;
+        entry->flags |= PageFlags::Write;
+    }
+
+    return entry->page->data;
+}
+
+void EmulatorMemory::flushTLB() const
+{
+    m_tlbindex = EMULATOR_NO_PAGE;
+    m_tlbentry = nullptr;
+    m_tlbwritable = false;
+}
+
+u64 EmulatorMemory::nextOwner()
+{
+    static std::atomic<u64> owner(0);
+    return ++owner;
+}
+
+} // namespace REDasm
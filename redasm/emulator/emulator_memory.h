@@ -0,0 +1,135 @@
+#pragma once
+
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <cstring>
+#include "../types/base_types.h"
+
+#define EMULATOR_PAGE_BITS  12
+#define EMULATOR_PAGE_SIZE  (static_cast<u64>(1) << EMULATOR_PAGE_BITS)
+#define EMULATOR_PAGE_MASK  (EMULATOR_PAGE_SIZE - 1)
+#define EMULATOR_TABLE_BITS 10 // Pages per second level table
+#define EMULATOR_TABLE_SIZE (static_cast<u64>(1) << EMULATOR_TABLE_BITS)
+#define EMULATOR_TABLE_MASK (EMULATOR_TABLE_SIZE - 1)
+#define EMULATOR_LOW_TABLES (static_cast<u64>(1) << (32 - EMULATOR_PAGE_BITS - EMULATOR_TABLE_BITS)) // Covers the low 4GB
+
+namespace REDasm {
+
+class EmulatorMemory // Copy-on-write overlay: reads go through to the loader's buffer, written pages are private
+{
+    private:
+        enum PageFlags: u32 {
+            None     = 0,
+            Resolved = 1,
+            Read     = 2,
+            Write    = 4, // Private page
+            Partial  = 8, // Not fully mapped or shared by more regions, accesses are range checked
+        };
+
+        struct Region { address_t address, endaddress; const u8* data; u64 size; }; // Bytes past 'size' read as zero
+        typedef std::shared_ptr<const std::vector<Region> > RegionsPtr;
+
+        struct Page { u8 data[EMULATOR_PAGE_SIZE]; };
+        typedef std::shared_ptr<Page> PagePtr;
+
+        // Tables and pages are shared between snapshots, they are modified only by their owner
+        // and copied by everyone else on the first write
+        struct PageEntry { const u8* data; PagePtr page; u32 flags; };
+        struct PageTable { PageEntry entries[EMULATOR_TABLE_SIZE]; u64 owner; };
+        typedef std::shared_ptr<PageTable> PageTablePtr;
+
+        struct Directory {
+            std::vector<PageTablePtr> lowtables;              // Flat first level for 32 bit guests
+            std::unordered_map<u64, PageTablePtr> hightables; // Sparse first level for everything above
+            size_t pages;
+            u64 owner;
+        };
+
+        typedef std::shared_ptr<Directory> DirectoryPtr;
+
+    public:
+        class Snapshot
+        {
+            private:
+                RegionsPtr m_regions;
+                DirectoryPtr m_directory;
+                friend class EmulatorMemory;
+        };
+
+    public:
+        EmulatorMemory();
+        bool empty() const;
+        size_t pages() const;
+        void clear();
+        void discard(); // Drops every written page
+        bool map(address_t address, u64 size, const u8* data = nullptr, u64 datasize = 0); // 'data' must outlive the mapping
+        bool isMapped(address_t address) const;
+        Snapshot snapshot() const;              // O(1), pages are copied on the next write
+        void restore(const Snapshot& snapshot); // O(1)
+        template<typename U> bool read(address_t address, U* value) const { return this->read(address, value, sizeof(U)); }
+        template<typename U> bool write(address_t address, U value) { return this->write(address, &value, sizeof(U)); }
+
+        bool read(address_t address, void* value, u64 size) const {
+            u64 offset = address & EMULATOR_PAGE_MASK;
+
+            if((offset + size) <= EMULATOR_PAGE_SIZE) {
+                const PageEntry* entry = this->lookup(address >> EMULATOR_PAGE_BITS);
+
+                if((entry->flags & (PageFlags::Read | PageFlags::Partial)) == PageFlags::Read) {
+                    std::memcpy(value, entry->data + offset, size);
+                    return true;
+                }
+            }
+
+            return this->readSlow(address, reinterpret_cast<u8*>(value), size);
+        }
+
+        bool write(address_t address, const void* value, u64 size) {
+            u64 offset = address & EMULATOR_PAGE_MASK;
+
+            if((offset + size) <= EMULATOR_PAGE_SIZE) {
+                const PageEntry* entry = this->lookup(address >> EMULATOR_PAGE_BITS);
+
+                if(m_tlbwritable && ((entry->flags & (PageFlags::Write | PageFlags::Partial)) == PageFlags::Write)) {
+                    std::memcpy(entry->page->data + offset, value, size);
+                    return true;
+                }
+            }
+
+            return this->writeSlow(address, reinterpret_cast<const u8*>(value), size);
+        }
+
+    private:
+        PageEntry* lookup(u64 pageindex) const {
+            if(pageindex == m_tlbindex) // Single entry TLB: the last page hit
+                return m_tlbentry;
+
+            return this->lookupSlow(pageindex);
+        }
+
+        PageEntry* lookupSlow(u64 pageindex) const;
+        PageTable* findTable(u64 pageindex) const;
+        PageTable* ownTable(u64 pageindex) const;
+        PageTable* ownTable(PageTablePtr& table) const;
+        Directory* ownDirectory() const;
+        bool readSlow(address_t address, u8* value, u64 size) const;
+        bool writeSlow(address_t address, const u8* value, u64 size);
+        const Region* region(address_t address) const;
+        void resolve(u64 pageindex, PageEntry* entry) const;
+        void materialize(u64 pageindex, PageEntry* entry) const;
+        u8* writablePage(u64 pageindex, PageEntry* entry) const;
+        void flushTLB() const;
+
+    private:
+        static u64 nextOwner();
+
+    private:
+        RegionsPtr m_regions; // Sorted by address, never overlapping
+        mutable DirectoryPtr m_directory;
+        mutable PageEntry* m_tlbentry;
+        mutable u64 m_tlbindex, m_owner;
+        mutable bool m_tlbwritable;
+};
+
+} // namespace REDasm
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <unordered_map>
+#include <array>
+#include "../types/base_types.h"
+
+#define EMULATOR_MAX_REGISTERS 256 // Wide enough for capstone's register enums
+
+namespace REDasm {
+
+struct RegisterFileDescriptor { size_t count; }; // Registers [0, count) are stored in a flat array, 0 means undeclared
+
+template<typename T> class EmulatorRegisters
+{
+    private:
+        typedef std::array<T, EMULATOR_MAX_REGISTERS> Values;
+        typedef std::unordered_map<T, T> Fallback;
+
+    public:
+        EmulatorRegisters(const RegisterFileDescriptor& descriptor);
+        T read(T r) const { return (r < m_count) ? m_values[r] : this->readFallback(r); }
+        void write(T r, T value) {
+            if(r < m_count)
+                m_values[r] = value;
+            else
+                m_fallback[r] = value;
+        }
+
+        void clear();
+
+    private:
+        T readFallback(T r) const;
+
+    private:
+        Values m_values;
+        Fallback m_fallback; // Registers outside the declared file
+        T m_count;
+};
+
+} // namespace REDasm
+
+#include "emulator_registers.hpp"
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "emulator_registers.h"
+#include <algorithm>
+
+namespace REDasm {
+
+template<typename T> EmulatorRegisters<T>::EmulatorRegisters(const RegisterFileDescriptor &descriptor): m_count(static_cast<T>(std::min<size_t>(descriptor.count, EMULATOR_MAX_REGISTERS))) { this->clear(); }
+
+template<typename T> void EmulatorRegisters<T>::clear()
+{
+    std::fill_n(m_values.begin(), m_count, 0);
+    m_fallback.clear();
+}
+
+template<typename T> T EmulatorRegisters<T>::readFallback(T r) const
+{
+    auto it = m_fallback.find(r);
+
+    if(it != m_fallback.end())
+        return it->second;
+
+    return 0;
+}
+
+} // namespace REDasm
@@ -8,7 +8,7 @@ namespace REDasm {
 template<typename T> class EmulatorT: public EmulatorALU<T>
 {
     public:
-        EmulatorT(DisassemblerAPI* disassembler);
+        EmulatorT(DisassemblerAPI* disassembler, const RegisterFileDescriptor& registerfile = { 0 });
         bool read(const Operand* op, u64* value) override;
 
     protected:
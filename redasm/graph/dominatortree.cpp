@@ -0,0 +1,221 @@
+#include "dominatortree.h"
+#include <algorithm>
+#include <stack>
+
+namespace REDasm {
+namespace Graphing {
+
+DominatorTree::DominatorTree(const Graph *graph, bool post): m_post(post)
+{
+    this->computeOrder(graph);
+    this->computeIDoms(graph);
+    this->computeTree();
+}
+
+bool DominatorTree::reachable(const Node &n) const { return this->valid(n) && m_ponumber[n]; }
+Node DominatorTree::idom(const Node &n) const { return this->reachable(n) ? m_idom[n] : 0; }
+
+bool DominatorTree::dominates(const Node &a, const Node &b) const
+{
+    if(!this->reachable(a) || !this->reachable(b))
+        return false;
+
+    return (m_enter[a] <= m_enter[b]) && (m_leave[b] <= m_leave[a]);
+}
+
+bool DominatorTree::strictlyDominates(const Node &a, const Node &b) const { return (a != b) && this->dominates(a, b); }
+
+const NodeList &DominatorTree::children(const Node &n) const
+{
+    static const NodeList nochildren;
+
+    if(!this->reachable(n))
+        return nochildren;
+
+    return m_children[n];
+}
+
+void DominatorTree::computeOrder(const Graph *graph)
+{
+    Node maxnode = 0;
+
+    for(const Node& n : graph->nodes())
+    {
+        maxnode = std::max(maxnode, n);
+
+        if(m_post ? graph->outgoing(n).empty() : (n == graph->root()))
+            m_roots.push_back(n);
+    }
+
+    m_idom.assign(static_cast<size_t>(maxnode) + 1, 0);
+    m_ponumber.assign(m_idom.size(), 0);
+
+    // Iterative DFS from the virtual root (Node 0), whose successors are m_roots
+    struct Frame { Node node; size_t next; };
+    std::vector<char> visited(m_idom.size(), false);
+    std::stack<Frame> frames;
+    NodeList postorder;
+
+    auto successor = [&](const Frame& frame, Node* s) -> bool {
+        if(!frame.node) {
+            if(frame.next >= m_roots.size()) return false;
+            *s = m_roots[frame.next];
+            return true;
+        }
+
+        EdgeRange edges = m_post ? graph->incoming(frame.node) : graph->outgoing(frame.node);
+        if(frame.next >= edges.size()) return false;
+        *s = m_post ? edges[frame.next].source : edges[frame.next].target;
+        return true;
+    };
+
+    visited[0] = true;
+    frames.push({ 0, 0 });
+
+    while(!frames.empty())
+    {
+        Frame& frame = frames.top();
+        Node s = 0;
+
+        if(successor(frame, &s))
+        {
+            frame.next++;
+
+            if(!visited[s])
+            {
+                visited[s] = true;
+                frames.push({ s, 0 });
+            }
+
+            continue;
+        }
+
+        if(frame.node)
+            postorder.push_back(frame.node);
+
+        frames.pop();
+    }
+
+    for(size_t i = 0; i < postorder.size(); i++)
+        m_ponumber[postorder[i]] = i + 1;
+
+    m_order.assign(postorder.rbegin(), postorder.rend());
+}
+
+void DominatorTree::computeIDoms(const Graph *graph)
+{
+    const size_t VIRTUAL_ROOT = m_order.size() + 1; // Postorder number of Node 0
+    std::vector<size_t> doms(m_order.size() + 2, 0); // Indexed by postorder number
+    std::vector<Node> nodes(m_order.size() + 2, 0);
+    doms[VIRTUAL_ROOT] = VIRTUAL_ROOT;
+
+    for(const Node& n : m_order)
+        nodes[m_ponumber[n]] = n;
+
+    std::vector<char> isroot(m_idom.size(), false);
+
+    for(const Node& n : m_roots)
+        isroot[n] = true;
+
+    auto number = [&](const Node& n) -> size_t { return n ? m_ponumber[n] : VIRTUAL_ROOT; };
+    bool changed = true;
+
+    while(changed)
+    {
+        changed = false;
+
+        for(const Node& n : m_order)
+        {
+            size_t newidom = 0;
+
+            auto process = [&](const Node& p) {
+                size_t pn = number(p);
+
+                if(!pn || !doms[pn]) // Unreachable or not processed yet
+                    return;
+
+                newidom = newidom ? DominatorTree::intersect(pn, newidom, doms) : pn;
+            };
+
+            if(isroot[n])
+                process(0);
+
+            EdgeRange edges = m_post ? graph->outgoing(n) : graph->incoming(n);
+
+            for(const Edge& e : edges)
+                process(m_post ? e.target : e.source);
+
+            size_t nn = m_ponumber[n];
+
+            if(doms[nn] == newidom)
+                continue;
+
+            doms[nn] = newidom;
+            changed = true;
+        }
+    }
+
+    for(const Node& n : m_order)
+    {
+        size_t d = doms[m_ponumber[n]];
+        m_idom[n] = (d == VIRTUAL_ROOT) ? 0 : nodes[d];
+    }
+}
+
+size_t DominatorTree::intersect(size_t b1, size_t b2, const std::vector<size_t>& doms)
+{
+    while(b1 != b2) // Walk up by postorder number: ancestors have higher numbers
+    {
+        while(b1 < b2)
+            b1 = doms[b1];
+
+        while(b2 < b1)
+            b2 = doms[b2];
+    }
+
+    return b1;
+}
+
+void DominatorTree::computeTree()
+{
+    NodeList roots;
+    m_children.assign(m_idom.size(), NodeList());
+    m_enter.assign(m_idom.size(), 0);
+    m_leave.assign(m_idom.size(), 0);
+
+    for(const Node& n : m_order) // Children are kept in reverse postorder
+    {
+        if(m_idom[n])
+            m_children[m_idom[n]].push_back(n);
+        else
+            roots.push_back(n);
+    }
+
+    std::stack< std::pair<Node, size_t> > pending;
+    size_t counter = 0;
+
+    for(const Node& root : roots)
+    {
+        m_enter[root] = counter++;
+        pending.push({ root, 0 });
+
+        while(!pending.empty())
+        {
+            auto& item = pending.top();
+
+            if(item.second < m_children[item.first].size())
+            {
+                Node child = m_children[item.first][item.second++];
+                m_enter[child] = counter++;
+                pending.push({ child, 0 });
+                continue;
+            }
+
+            m_leave[item.first] = counter++;
+            pending.pop();
+        }
+    }
+}
+
+} // namespace Graphing
+} // namespace REDasm
@@ -0,0 +1,41 @@
+#pragma once
+
+// Cooper, Harvey, Kennedy - A Simple, Fast Dominance Algorithm
+// - https://www.cs.rice.edu/~keith/EMBED/dom.pdf
+
+#include <vector>
+#include "graph.h"
+
+namespace REDasm {
+namespace Graphing {
+
+class DominatorTree
+{
+    public:
+        DominatorTree(const Graph* graph, bool post = false); // post: post-dominators, rooted at the exit nodes
+        bool isPostDominator() const { return m_post; }
+        bool reachable(const Node& n) const;
+        Node idom(const Node& n) const;                       // 0 for roots and unreachable nodes
+        bool dominates(const Node& a, const Node& b) const;   // Reflexive
+        bool strictlyDominates(const Node& a, const Node& b) const;
+        const NodeList& children(const Node& n) const;
+        const NodeList& order() const { return m_order; }    // Reverse postorder
+
+    private:
+        void computeOrder(const Graph* graph);
+        void computeIDoms(const Graph* graph);
+        void computeTree();
+        static size_t intersect(size_t b1, size_t b2, const std::vector<size_t>& doms);
+        bool valid(const Node& n) const { return (n > 0) && (static_cast<size_t>(n) < m_idom.size()); }
+
+    private:
+        bool m_post;
+        NodeList m_roots, m_order;
+        std::vector<Node> m_idom;                    // Indexed by Node, 0 is the virtual root
+        std::vector<size_t> m_ponumber;              // Indexed by Node, postorder number + 1 (0: unreachable)
+        std::vector<size_t> m_enter, m_leave;        // DFS interval in the dominator tree
+        std::vector<NodeList> m_children;
+};
+
+} // namespace Graphing
+} // namespace REDasm
@@ -3,7 +3,7 @@
 namespace REDasm {
 namespace Graphing {
 
-FunctionGraph::FunctionGraph(DisassemblerAPI *disassembler): GraphT<FunctionBasicBlock>(), m_disassembler(disassembler), m_document(disassembler->document()) { }
+FunctionGraph::FunctionGraph(DisassemblerAPI *disassembler): GraphT<FunctionBasicBlock>(), m_disassembler(disassembler), m_document(disassembler->document().get()) { }
 bool FunctionGraph::containsItem(size_t index) const { return this->basicBlockFromIndex(index) != nullptr; }
 
 bool FunctionGraph::build(address_t address)
@@ -16,14 +16,38 @@ bool FunctionGraph::build(address_t address)
     return false;
 }
 
-const FunctionBasicBlock *FunctionGraph::basicBlockFromIndex(size_t index) const
+bool FunctionGraph::rebase()
 {
+    m_basicblockindex.clear();
+
     for(auto& item : this->data())
     {
-        if(item.second.contains(index))
-            return &item.second;
+        FunctionBasicBlock& fbb = item.second;
+        auto it = m_anchors.find(item.first);
+
+        if(it == m_anchors.end())
+            return false;
+
+        size_t startidx = this->anchorIndex(it->second.first), endidx = this->anchorIndex(it->second.second);
+
+        if((startidx == REDasm::npos) || (endidx == REDasm::npos) || ((endidx - startidx) != (fbb.endidx - fbb.startidx)))
+            return false; // Boundaries are gone or the block has grown: it needs to be rebuilt
+
+        fbb.startidx = startidx;
+        fbb.endidx = endidx;
+        m_basicblockindex.insert(fbb.startidx, fbb.endidx, fbb.node);
     }
 
+    return true;
+}
+
+const FunctionBasicBlock *FunctionGraph::basicBlockFromIndex(size_t index) const
+{
+    auto it = m_basicblockindex.find(index);
+
+    if(it != m_basicblockindex.end())
+        return this->data(it->second.value);
+
     return nullptr;
 }
 
@@ -31,16 +55,20 @@ FunctionBasicBlock *FunctionGraph::basicBlockFromIndex(size_t index) { return co
 
 bool FunctionGraph::build(const ListingItem *item)
 {
-    if(!item || !item->is(ListingItem::FunctionItem))
+    if(!this->buildBlocks(item))
         return false;
 
-    m_graphstart = REDasm::make_location(item->address);
-    this->buildBasicBlocks();
+    return this->connectBasicBlocks();
+}
 
-    if(this->empty())
+bool FunctionGraph::buildBlocks(const ListingItem *item)
+{
+    if(!item || !item->is(ListingItem::FunctionItem))
         return false;
 
-    return this->connectBasicBlocks();
+    m_graphstart = REDasm::make_location(item->address);
+    this->buildBasicBlocks();
+    return !this->empty();
 }
 
 void FunctionGraph::buildBasicBlocks()
@@ -188,6 +216,13 @@ void FunctionGraph::resetQueue()
     m_pending.swap(clean);
 }
 
+size_t FunctionGraph::anchorIndex(const BasicBlockAnchor &anchor) const
+{
+    return m_document->indexOf(std::make_unique<ListingItem>(anchor.address, anchor.type, anchor.index));
+}
+
+FunctionGraph::BasicBlockAnchor FunctionGraph::anchor(const ListingItem *item) { return { item->address, item->type, item->index }; }
+
 void FunctionGraph::buildBasicBlock(size_t index)
 {
     if(this->basicBlockFromIndex(index))
@@ -262,6 +297,8 @@ void FunctionGraph::buildBasicBlock(size_t index)
 
     fbb.node = this->newNode();
     this->setData(fbb.node, fbb);
+    m_basicblockindex.insert(fbb.startidx, fbb.endidx, fbb.node);
+    m_anchors[fbb.node] = { FunctionGraph::anchor(m_document->itemAt(fbb.startidx)), FunctionGraph::anchor(m_document->itemAt(fbb.endidx)) };
 
     if(!this->root())
         this->setRoot(fbb.node);
@@ -3,6 +3,7 @@
 #include <queue>
 #include "../disassembler/disassemblerapi.h"
 #include "../disassembler/listing/listingdocument.h"
+#include "../support/containers/interval_map.h"
 #include "graph.h"
 
 namespace REDasm {
@@ -36,12 +37,18 @@ class FunctionGraph: public GraphT<FunctionBasicBlock>
 {
     private:
         typedef std::queue<size_t> IndexQueue;
+        typedef interval_map<size_t, Node> BasicBlockIndex;
+        struct BasicBlockAnchor { address_t address; size_t type, index; }; // Survives insertions before the block
+        typedef std::unordered_map< Node, std::pair<BasicBlockAnchor, BasicBlockAnchor> > BasicBlockAnchors;
 
     public:
         FunctionGraph(DisassemblerAPI* disassembler);
         bool containsItem(size_t index) const;
         bool build(const ListingItem *item);
         bool build(address_t address);
+        bool buildBlocks(const ListingItem* item); // Boundaries only, without edges
+        bool connectBasicBlocks();
+        bool rebase();
 
     private:
         const FunctionBasicBlock* basicBlockFromIndex(size_t index) const;
@@ -51,18 +58,21 @@ class FunctionGraph: public GraphT<FunctionBasicBlock>
         bool isStopItem(const ListingItem *item) const;
         void buildBasicBlock(size_t index);
         void buildBasicBlocks();
-        bool connectBasicBlocks();
 
     private:
         size_t instructionIndexFromIndex(size_t idx) const;
         size_t symbolIndexFromIndex(size_t idx) const;
         void resetQueue();
+        size_t anchorIndex(const BasicBlockAnchor& anchor) const;
+        static BasicBlockAnchor anchor(const ListingItem* item);
 
     private:
         DisassemblerAPI* m_disassembler;
-        ListingDocument& m_document;
+        ListingDocumentType* m_document; // Callers must hold the document lock while building
         address_location m_graphstart;
         IndexQueue m_pending;
+        BasicBlockIndex m_basicblockindex;
+        BasicBlockAnchors m_anchors;
 };
 
 } // namespace Graphing
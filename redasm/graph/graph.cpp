@@ -1,4 +1,6 @@
 #include "graph.h"
+#include "dominatortree.h"
+#include "loopforest.h"
 #include <algorithm>
 
 namespace REDasm {
@@ -6,16 +8,26 @@ namespace Graphing {
 
 bool Graph::containsEdge(const Node &source, const Node &target) const
 {
-    for(const Edge& e : m_edges)
+    for(const Edge& e : this->outgoing(source))
     {
-        if((e.source == source) && (e.target == target))
+        if(e.target == target)
             return true;
     }
 
     return false;
 }
 
-void Graph::removeEdge(const Edge &edge) { m_edges.erase(std::find(m_edges.begin(), m_edges.end(), edge)); }
+void Graph::removeEdge(const Edge &edge)
+{
+    auto it = std::find(m_edges.begin(), m_edges.end(), edge);
+
+    if(it == m_edges.end())
+        return;
+
+    m_edges.erase(it);
+    this->rebuildAdjacency(); // Edge ids are positions, shift them
+    this->invalidateAnalyses();
+}
 
 void Graph::removeNode(const Node &n)
 {
@@ -29,62 +41,90 @@ void Graph::removeNode(const Node &n)
     }
 
     this->removeEdges(n);
+    this->invalidateAnalyses();
 }
 
-EdgeList Graph::outgoing(const Node &n) const
-{
-    EdgeList oe;
+EdgeRange Graph::outgoing(const Node &n) const { return EdgeRange(&m_edges, &this->adjacency(m_outgoing, n)); }
+EdgeRange Graph::incoming(const Node &n) const { return EdgeRange(&m_edges, &this->adjacency(m_incoming, n)); }
 
-    for(auto it = m_edges.begin(); it != m_edges.end(); it++)
+Edge Graph::edge(const Node &source, const Node &target) const
+{
+    for(const Edge& e : this->outgoing(source))
     {
-        if(it->source != n)
-            continue;
-
-        oe.push_back(*it);
+        if(e.target == target)
+            return e;
     }
 
-    return oe;
+    return Edge();
 }
 
-EdgeList Graph::incoming(const Node &n) const
+EdgeId Graph::newEdge(const Node &source, const Node &target)
 {
-    EdgeList ie;
+    EdgeRange oe = this->outgoing(source);
 
-    for(auto it = m_edges.begin(); it != m_edges.end(); it++)
+    for(auto it = oe.begin(); it != oe.end(); it++)
     {
-        if(it->target != n)
-            continue;
+        if(it->target == target)
+            return it.id();
+    }
 
-        ie.push_back(*it);
+    EdgeId id = m_edges.size();
+    m_edges.emplace_back(source, target);
+
+    size_t maxnode = static_cast<size_t>(std::max(source, target));
+
+    if(maxnode >= m_outgoing.size())
+    {
+        m_outgoing.resize(maxnode + 1);
+        m_incoming.resize(maxnode + 1);
     }
 
-    return ie;
+    m_outgoing[source].push_back(id);
+    m_incoming[target].push_back(id);
+    this->invalidateAnalyses();
+    return id;
 }
 
-Edge Graph::edge(const Node &source, const Node &target) const
+Node Graph::newNode()
 {
-    for(const Edge& e : m_edges)
-    {
-        if((e.source == source) && (e.target == target))
-            return e;
-    }
+    Node n = ++m_nodeid;
+    m_nodes.push_back(n);
+    this->invalidateAnalyses();
+    return n;
+}
 
-    return Edge();
+const DominatorTree &Graph::dominators() const
+{
+    if(!m_dominators)
+        m_dominators = std::make_shared<DominatorTree>(this);
+
+    return *m_dominators;
 }
 
-void Graph::newEdge(const Node &source, const Node &target)
+const DominatorTree &Graph::postDominators() const
 {
-    if(this->containsEdge(source, target))
-        return;
+    if(!m_postdominators)
+        m_postdominators = std::make_shared<DominatorTree>(this, true);
 
-    m_edges.emplace_back(source, target);
+    return *m_postdominators;
 }
 
-Node Graph::newNode()
+const LoopForest &Graph::loops() const
 {
-    Node n = ++m_nodeid;
-    m_nodes.push_back(n);
-    return n;
+    if(!m_loops)
+    {
+        this->dominators();
+        m_loops = std::make_shared<LoopForest>(this, m_dominators);
+    }
+
+    return *m_loops;
+}
+
+void Graph::invalidateAnalyses()
+{
+    m_dominators.reset();
+    m_postdominators.reset();
+    m_loops.reset();
 }
 
 void Graph::removeEdges(const Node &n)
@@ -98,6 +138,34 @@ void Graph::removeEdges(const Node &n)
         else
             it++;
     }
+
+    this->rebuildAdjacency();
+}
+
+void Graph::rebuildAdjacency()
+{
+    for(EdgeIds& ids : m_outgoing)
+        ids.clear();
+
+    for(EdgeIds& ids : m_incoming)
+        ids.clear();
+
+    for(EdgeId id = 0; id < m_edges.size(); id++)
+    {
+        const Edge& e = m_edges[id];
+        m_outgoing[e.source].push_back(id);
+        m_incoming[e.target].push_back(id);
+    }
+}
+
+const EdgeIds &Graph::adjacency(const std::vector<EdgeIds>& adjacency, const Node &n) const
+{
+    static const EdgeIds noedges;
+
+    if((n < 0) || (static_cast<size_t>(n) >= adjacency.size()))
+        return noedges;
+
+    return adjacency[n];
 }
 
 } // namespace Graphing
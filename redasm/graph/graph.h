@@ -2,7 +2,10 @@
 
 #include <unordered_map>
 #include <cstddef>
+#include <memory>
+#include <iterator>
 #include <string>
+#include <vector>
 #include <deque>
 #include <list>
 
@@ -24,8 +27,45 @@ struct Edge {
     bool operator !=(const Edge& e) const { return (source != e.source) || (target != e.target); }
 };
 
+typedef size_t EdgeId;
 typedef std::deque<Edge> EdgeList;
 typedef std::deque<Node> NodeList;
+typedef std::vector<EdgeId> EdgeIds;
+
+// Non-owning view of a node's edges: it points into the graph's adjacency lists,
+// so any newNode(), newEdge(), removeNode() or removeEdge() may invalidate it
+class EdgeRange
+{
+    public:
+        class const_iterator: public std::iterator<std::forward_iterator_tag, Edge, std::ptrdiff_t, const Edge*, const Edge&> {
+            public:
+                const_iterator(): m_edges(nullptr) { }
+                const_iterator(const EdgeList* edges, EdgeIds::const_iterator it): m_edges(edges), m_it(it) { }
+                const_iterator& operator++() { m_it++; return *this; }
+                const_iterator operator++(int) { const_iterator copy = *this; m_it++; return copy; }
+                bool operator==(const const_iterator& rhs) const { return m_it == rhs.m_it; }
+                bool operator!=(const const_iterator& rhs) const { return m_it != rhs.m_it; }
+                const Edge& operator*() const { return (*m_edges)[*m_it]; }
+                const Edge* operator->() const { return &(*m_edges)[*m_it]; }
+                EdgeId id() const { return *m_it; }
+
+            private:
+                const EdgeList* m_edges;
+                EdgeIds::const_iterator m_it;
+        };
+
+    public:
+        EdgeRange(const EdgeList* edges, const EdgeIds* ids): m_edges(edges), m_ids(ids) { }
+        const_iterator begin() const { return const_iterator(m_edges, m_ids->begin()); }
+        const_iterator end() const { return const_iterator(m_edges, m_ids->end()); }
+        const Edge& operator[](size_t idx) const { return (*m_edges)[(*m_ids)[idx]]; }
+        size_t size() const { return m_ids->size(); }
+        bool empty() const { return m_ids->empty(); }
+
+    private:
+        const EdgeList* m_edges;
+        const EdgeIds* m_ids;
+};
 
 struct NodeAttributes {
     NodeAttributes(): x(0), y(0), width(0), height(0) { }
@@ -43,7 +83,8 @@ struct EdgeAttributes {
 namespace std {
 template<> struct hash<REDasm::Graphing::Edge> {
     size_t operator()(const REDasm::Graphing::Edge& edge) const {
-        return edge.source ^ edge.target;
+        return std::hash<unsigned long long>()((static_cast<unsigned long long>(static_cast<unsigned int>(edge.source)) << 32) |
+                                               static_cast<unsigned int>(edge.target));
     }
 };
 } // namespace std
@@ -51,6 +92,9 @@ template<> struct hash<REDasm::Graphing::Edge> {
 namespace REDasm {
 namespace Graphing {
 
+class DominatorTree;
+class LoopForest;
+
 class Graph
 {
     public:
@@ -59,20 +103,29 @@ class Graph
         bool containsEdge(const Node& source, const Node& target) const;
         void removeEdge(const Edge& edge);
         void removeNode(const Node& n);
-        EdgeList outgoing(const Node& n) const;
-        EdgeList incoming(const Node& n) const;
+        EdgeRange outgoing(const Node& n) const;
+        EdgeRange incoming(const Node& n) const;
         const NodeList& nodes() const { return m_nodes; }
         const EdgeList& edges() const { return m_edges; }
+        const Edge& edge(EdgeId id) const { return m_edges[id]; }
         Edge edge(const Node& source, const Node& target) const;
-        void newEdge(const Node& source, const Node& target);
+        EdgeId newEdge(const Node& source, const Node& target);
         Node newNode();
-        Node root() { return m_root; }
+        Node root() const { return m_root; }
+
+    public: // Analyses, computed on demand and kept until the graph changes
+        const DominatorTree& dominators() const;
+        const DominatorTree& postDominators() const;
+        const LoopForest& loops() const;
 
     protected:
-        void setRoot(const Node& n) { m_root = n; }
+        void setRoot(const Node& n) { m_root = n; this->invalidateAnalyses(); }
 
     private:
+        void invalidateAnalyses();
         void removeEdges(const Node& n);
+        void rebuildAdjacency();
+        const EdgeIds& adjacency(const std::vector<EdgeIds>& adjacency, const Node& n) const;
 
     public: // Styling
         int areaWidth() const { return m_areawidth; }
@@ -105,6 +158,9 @@ class Graph
         NodeList m_nodes;
 
     private:
+        std::vector<EdgeIds> m_outgoing, m_incoming; // Indexed by Node
+        mutable std::shared_ptr<const DominatorTree> m_dominators, m_postdominators;
+        mutable std::shared_ptr<const LoopForest> m_loops;
         Node m_root;
 };
 
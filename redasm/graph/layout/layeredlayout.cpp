@@ -1,7 +1,6 @@
 #include "layeredlayout.h"
-#include <unordered_set>
+#include <unordered_map>
 #include <queue>
-#include <iostream>
 
 #define LLAYOUT_PADDING      16
 #define LLAYOUT_PADDING_DIV2 (LLAYOUT_PADDING / 2)
@@ -11,67 +10,173 @@
 namespace REDasm {
 namespace Graphing {
 
-LayeredLayout::LayeredLayout(Graph *graph): AbstractLayout(graph), m_layouttype(LayoutType::Medium) { }
+void LLEdgeGrid::reset(int rows, int cols)
+{
+    m_rows = rows;
+    m_cols = cols;
+    m_bits.assign(static_cast<size_t>(rows) * cols * m_words, 0);
+    m_extents.assign(static_cast<size_t>(rows) * cols, 0);
+}
+
+bool LLEdgeGrid::isMarked(int row, int col, int index) const
+{
+    if(index >= this->extent(row, col))
+        return false;
+
+    size_t idx = static_cast<size_t>(index);
+    return m_bits[(this->cell(row, col) * m_words) + (idx / 64)] & (1ull << (idx % 64));
+}
+
+void LLEdgeGrid::mark(int row, int col, int index, bool used)
+{
+    size_t idx = static_cast<size_t>(index), c = this->cell(row, col);
+
+    if(idx >= (m_words * 64))
+        this->grow(std::max(m_words * 2, (idx / 64) + 1));
+
+    u64& word = m_bits[(c * m_words) + (idx / 64)];
+
+    if(used)
+        word |= (1ull << (idx % 64));
+    else
+        word &= ~(1ull << (idx % 64));
+
+    m_extents[c] = std::max(m_extents[c], index + 1);
+}
+
+void LLEdgeGrid::grow(size_t words)
+{
+    std::vector<u64> bits(m_extents.size() * words, 0);
+
+    for(size_t c = 0; c < m_extents.size(); c++)
+        std::copy_n(m_bits.begin() + (c * m_words), m_words, bits.begin() + (c * words));
+
+    m_bits.swap(bits);
+    m_words = words;
+}
+
+LayeredLayout::LayeredLayout(Graph *graph): AbstractLayout(graph), m_cancelled(nullptr), m_gridcols(0), m_layouttype(LayoutType::Medium) { }
 void LayeredLayout::setLayoutType(int lt) { m_layouttype = lt; }
+void LayeredLayout::setCancelled(const std::atomic<bool> *cancelled) { m_cancelled = cancelled; }
+bool LayeredLayout::isCancelled() const { return m_cancelled && m_cancelled->load(); }
 
 bool LayeredLayout::execute()
 {
     if(!m_graph->root())
         return false;
 
-    m_blocks.clear();
-    m_colx.clear();
-    m_rowy.clear();
-    m_rowedgey.clear();
-    m_colwidth.clear();
-    m_rowheight.clear();
-    m_coledgecount.clear();
-    m_rowedgey.clear();
+    LayoutCache::Key key = LayoutCache::key(m_graph, m_layouttype);
+
+    if(LayoutCache::restore(key, m_graph)) // Same structure, same sizes: reuse the previous result
+        return true;
+
     m_blockorder.clear();
-    m_horizedges.clear();
-    m_vertedges.clear();
-    m_edgevalid.clear();
 
     this->createBlocks();                           // Create render nodes
     this->makeAcyclic();                            // Construct acyclic graph where each node is used as an edge exactly once
-    this->computeLayout(m_blocks[m_graph->root()]); // Compute graph layout from bottom up
+
+    if(this->isCancelled())
+        return this->cancel();
+
+    this->computeLayout(this->block(m_graph->root())); // Compute graph layout from bottom up
     this->prepareEdgeRouting();                     // Prepare edge routing
     this->performEdgeRouting();                     // Perform edge routing
+
+    if(this->isCancelled())
+        return this->cancel();
+
     this->computeEdgeCount();                       // Compute edge counts for each row and column
     this->computeRowColumnSizes();                  // Compute row and column sizes
     this->computeRowColumnPositions();              // Compute row and column positions
     this->computeNodePositions();                   // Compute node positions
     this->precomputeEdgeCoordinates();              // Precompute coordinates for edges
+    this->cacheLayout(key);
     return true;
 }
 
+bool LayeredLayout::cancel()
+{
+    for(const LLBlock& block : m_blocks) // Undo node padding, the graph is left as it was
+        m_graph->height(block.node, block.height - LLAYOUT_NODE_PADDING);
+
+    return false;
+}
+
+void LayeredLayout::cacheLayout(const LayoutCache::Key &key) const
+{
+    LayoutCache::Layout layout;
+    layout.areawidth = m_graph->areaWidth();
+    layout.areaheight = m_graph->areaHeight();
+    layout.nodes.reserve(m_blocks.size());
+
+    for(const LLBlock& block : m_blocks)
+    {
+        NodeAttributes attributes;
+        attributes.x = m_graph->x(block.node);
+        attributes.y = m_graph->y(block.node);
+        attributes.width = m_graph->width(block.node);
+        attributes.height = m_graph->height(block.node);
+        layout.nodes.emplace_back(block.node, attributes);
+
+        for(const LLEdge& edge : block.edges)
+        {
+            Edge e = m_graph->edge(edge.sourceblock->node, edge.targetblock->node);
+
+            if(!e.valid())
+                continue;
+
+            layout.edges.push_back({ e, edge.routes, edge.arrow });
+        }
+    }
+
+    LayoutCache::store(key, std::move(layout));
+}
+
 void LayeredLayout::createBlocks()
 {
-    for(const Node& n : m_graph->nodes())
+    const NodeList& nodes = m_graph->nodes();
+    Node maxnode = nodes.empty() ? 0 : *std::max_element(nodes.begin(), nodes.end());
+
+    m_blockindex.assign(static_cast<size_t>(maxnode) + 1, 0);
+    m_blocks.resize(nodes.size());
+
+    for(size_t i = 0; i < nodes.size(); i++)
     {
+        const Node& n = nodes[i];
         m_graph->height(n, m_graph->height(n) + LLAYOUT_NODE_PADDING); // Pad Node
-        m_blocks[n] = LLBlock(n, m_graph->width(n), m_graph->height(n));
+        m_blocks[i].reset(n, m_graph->width(n), m_graph->height(n));
+        m_blockindex[n] = i;
     }
 
+    // makeAcyclic() breaks ties by scan order: keep the one of the original unordered_map<Node, LLBlock>,
+    // built with the same insertions, so layouts don't change
+    std::unordered_map<Node, size_t> scanorder;
+    m_scanorder.clear();
+
+    for(size_t i = 0; i < nodes.size(); i++)
+        scanorder[nodes[i]] = i;
+
+    for(const auto& item : scanorder)
+        m_scanorder.push_back(item.second);
+
     //Populate incoming lists
-    for(const auto& item : m_blocks)
+    for(const LLBlock& block : m_blocks)
     {
-        const LLBlock& block = item.second;
-
-        for(const Edge& edge : m_graph->outgoing(item.first))
-            m_blocks[edge.target].incoming.push_back(block.node);
+        for(const Edge& edge : m_graph->outgoing(block.node))
+            this->block(edge.target).incoming.push_back(block.node);
     }
 }
 
 void LayeredLayout::makeAcyclic()
 {
     //Construct acyclic graph where each node is used as an edge exactly once
-    std::unordered_set<Node> visited;
+    auto visited = [&](const Node& n) -> char& { return m_visited[m_blockindex[n]]; };
     std::queue<Node> queue;
     bool changed = true;
 
-    visited.insert(m_graph->root());
-    queue.push(m_blocks[m_graph->root()].node);
+    m_visited.assign(m_blocks.size(), false);
+    visited(m_graph->root()) = true;
+    queue.push(m_graph->root());
 
     while(changed)
     {
@@ -80,48 +185,52 @@ void LayeredLayout::makeAcyclic()
         //First pick nodes that have single entry points
         while(!queue.empty())
         {
-            LLBlock& block = m_blocks[queue.front()];
+            LLBlock& block = this->block(queue.front());
             queue.pop();
             m_blockorder.push_back(block.node);
 
             for(const Edge& edge : m_graph->outgoing(block.node))
             {
-                if(visited.count(edge.target))
+                if(visited(edge.target))
                     continue;
 
+                LLBlock& target = this->block(edge.target);
+
                 //If node has no more unseen incoming edges, add it to the graph layout now
-                if(m_blocks[edge.target].incoming.size() == 1)
+                if(target.incoming.size() == 1)
                 {
-                    LayeredLayout::removeFromDeque(m_blocks[edge.target].incoming, block.node);
+                    LayeredLayout::removeFromVector(target.incoming, block.node);
                     block.newoutgoing.push_back(edge.target);
-                    queue.push(m_blocks[edge.target].node);
-                    visited.insert(edge.target);
+                    queue.push(target.node);
+                    visited(edge.target) = true;
                     changed = true;
                 }
                 else
-                    LayeredLayout::removeFromDeque(m_blocks[edge.target].incoming, block.node);
+                    LayeredLayout::removeFromVector(target.incoming, block.node);
             }
         }
 
         //No more nodes satisfy constraints, pick a node to continue constructing the graph
         int best = 0, bestparent, bestedges;
 
-        for(auto& item : m_blocks)
+        for(size_t idx : m_scanorder)
         {
-            LLBlock& block = item.second;
+            const LLBlock& block = m_blocks[idx];
 
-            if(!visited.count(block.node))
+            if(!visited(block.node))
                 continue;
 
             for(const Edge& edge : m_graph->outgoing(block.node))
             {
-                if(visited.count(edge.target))
+                if(visited(edge.target))
                     continue;
 
-                if(!best || (m_blocks[edge.target].incoming.size() < bestedges) || ((m_blocks[edge.target].incoming.size() == bestedges) && (edge.target < best)))
+                int incomingcount = static_cast<int>(this->block(edge.target).incoming.size());
+
+                if(!best || (incomingcount < bestedges) || ((incomingcount == bestedges) && (edge.target < best)))
                 {
                     best = edge.target;
-                    bestedges = static_cast<int>(m_blocks[edge.target].incoming.size());
+                    bestedges = incomingcount;
                     bestparent = block.node;
                 }
             }
@@ -129,10 +238,10 @@ void LayeredLayout::makeAcyclic()
 
         if(best)
         {
-            LLBlock& bestparentb = m_blocks[bestparent];
-            LayeredLayout::removeFromDeque(m_blocks[best].incoming, bestparentb.node);
+            LLBlock& bestparentb = this->block(bestparent);
+            LayeredLayout::removeFromVector(this->block(best).incoming, bestparentb.node);
             bestparentb.newoutgoing.push_back(best);
-            visited.insert(best);
+            visited(best) = true;
             queue.push(best);
             changed = true;
         }
@@ -141,72 +250,55 @@ void LayeredLayout::makeAcyclic()
 
 void LayeredLayout::prepareEdgeRouting()
 {
-    m_horizedges.resize(m_blocks[m_graph->root()].rowcount + 1);
-    m_vertedges.resize(m_blocks[m_graph->root()].rowcount + 1);
-    m_edgevalid.resize(m_blocks[m_graph->root()].rowcount + 1);
+    const LLBlock& root = this->block(m_graph->root());
+    m_gridcols = root.colcount + 1;
 
-    for(size_t row = 0; row < m_blocks[m_graph->root()].rowcount + 1; row++)
-    {
-        m_horizedges[row].resize(m_blocks[m_graph->root()].colcount + 1);
-        m_vertedges[row].resize(m_blocks[m_graph->root()].colcount + 1);
-        LayeredLayout::initDeque(m_edgevalid[row], m_blocks[m_graph->root()].colcount + 1, true);
+    m_horizedges.reset(root.rowcount + 1, m_gridcols);
+    m_vertedges.reset(root.rowcount + 1, m_gridcols);
+    LayeredLayout::initVector<char>(m_edgevalid, static_cast<size_t>(root.rowcount + 1) * m_gridcols, true);
 
-        for(int col = 0; col < m_blocks[m_graph->root()].colcount + 1; col++)
-        {
-            m_horizedges[row][col].clear();
-            m_vertedges[row][col].clear();
-        }
-    }
-
-    for(const auto& item : m_blocks)
-    {
-        const LLBlock& block = item.second;
-        m_edgevalid[block.row][block.col + 1] = false;
-    }
+    for(const LLBlock& block : m_blocks)
+        m_edgevalid[(static_cast<size_t>(block.row) * m_gridcols) + block.col + 1] = false;
 }
 
 void LayeredLayout::performEdgeRouting()
 {
     for(const Node& n : m_blockorder)
     {
-        LLBlock& block = m_blocks[n];
-        LLBlock& start = block;
+        LLBlock& start = this->block(n);
 
-        for(const Edge& edge : m_graph->outgoing(block.node))
+        for(const Edge& edge : m_graph->outgoing(start.node))
         {
-            LLBlock& end = m_blocks[edge.target];
-            start.edges.push_back(this->routeEdge(m_horizedges, m_vertedges, m_edgevalid, start, end));
+            LLBlock& end = this->block(edge.target);
+            start.edges.push_back(this->routeEdge(start, end));
         }
     }
 }
 
 void LayeredLayout::computeEdgeCount()
 {
-    LayeredLayout::initDeque(m_coledgecount, m_blocks[m_graph->root()].colcount + 1, 0);
-    LayeredLayout::initDeque(m_rowedgecount, m_blocks[m_graph->root()].rowcount + 1, 0);
+    const LLBlock& root = this->block(m_graph->root());
+    LayeredLayout::initVector(m_coledgecount, root.colcount + 1, 0);
+    LayeredLayout::initVector(m_rowedgecount, root.rowcount + 1, 0);
 
-    for(int row = 0; row < m_blocks[m_graph->root()].rowcount + 1; row++)
+    for(int row = 0; row < root.rowcount + 1; row++)
     {
-        for(int col = 0; col < m_blocks[m_graph->root()].colcount + 1; col++)
+        for(int col = 0; col < root.colcount + 1; col++)
         {
-            if(static_cast<int>(m_horizedges[row][col].size()) > m_rowedgecount[row])
-                m_rowedgecount[row] = static_cast<int>(m_horizedges[row][col].size());
-
-            if(static_cast<int>(m_vertedges[row][col].size()) > m_coledgecount[col])
-                m_coledgecount[col] = static_cast<int>(m_vertedges[row][col].size());
+            m_rowedgecount[row] = std::max(m_rowedgecount[row], m_horizedges.extent(row, col));
+            m_coledgecount[col] = std::max(m_coledgecount[col], m_vertedges.extent(row, col));
         }
     }
 }
 
 void LayeredLayout::computeRowColumnSizes()
 {
-    LayeredLayout::initDeque(m_colwidth, m_blocks[m_graph->root()].colcount + 1, 0);
-    LayeredLayout::initDeque(m_rowheight, m_blocks[m_graph->root()].rowcount + 1, 0);
+    const LLBlock& root = this->block(m_graph->root());
+    LayeredLayout::initVector(m_colwidth, root.colcount + 1, 0);
+    LayeredLayout::initVector(m_rowheight, root.rowcount + 1, 0);
 
-    for(const auto & item : m_blocks)
+    for(const LLBlock& block : m_blocks)
     {
-        const LLBlock& block = item.second;
-
         if((block.width / 2) > m_colwidth[block.col])
             m_colwidth[block.col] = block.width / 2;
 
@@ -220,14 +312,15 @@ void LayeredLayout::computeRowColumnSizes()
 
 void LayeredLayout::computeRowColumnPositions()
 {
-    LayeredLayout::initDeque(m_colx, m_blocks[m_graph->root()].colcount, 0);
-    LayeredLayout::initDeque(m_rowy, m_blocks[m_graph->root()].rowcount, 0);
-    LayeredLayout::initDeque(m_coledgex, m_blocks[m_graph->root()].colcount + 1, 0);
-    LayeredLayout::initDeque(m_rowedgey, m_blocks[m_graph->root()].rowcount + 1, 0);
+    const LLBlock& root = this->block(m_graph->root());
+    LayeredLayout::initVector(m_colx, root.colcount, 0);
+    LayeredLayout::initVector(m_rowy, root.rowcount, 0);
+    LayeredLayout::initVector(m_coledgex, root.colcount + 1, 0);
+    LayeredLayout::initVector(m_rowedgey, root.rowcount + 1, 0);
 
     int x = LLAYOUT_PADDING;
 
-    for(int i = 0; i < m_blocks[m_graph->root()].colcount; i++)
+    for(int i = 0; i < root.colcount; i++)
     {
         m_coledgex[i] = x;
         x += LLAYOUT_PADDING_DIV2 * m_coledgecount[i];
@@ -237,7 +330,7 @@ void LayeredLayout::computeRowColumnPositions()
 
     int y = LLAYOUT_PADDING;
 
-    for(int i = 0; i < m_blocks[m_graph->root()].rowcount; i++)
+    for(int i = 0; i < root.rowcount; i++)
     {
         m_rowedgey[i] = y;
         y += LLAYOUT_PADDING_DIV2 * m_rowedgecount[i];
@@ -245,17 +338,16 @@ void LayeredLayout::computeRowColumnPositions()
         y += m_rowheight[i];
     }
 
-    m_coledgex[m_blocks[m_graph->root()].colcount] = x;
-    m_rowedgey[m_blocks[m_graph->root()].rowcount] = y;
-    m_graph->areaWidth(x + LLAYOUT_PADDING + (LLAYOUT_PADDING_DIV2 * m_coledgecount[m_blocks[m_graph->root()].colcount]));
-    m_graph->areaHeight(y + LLAYOUT_PADDING + (LLAYOUT_PADDING_DIV2 * m_rowedgecount[m_blocks[m_graph->root()].rowcount]));
+    m_coledgex[root.colcount] = x;
+    m_rowedgey[root.rowcount] = y;
+    m_graph->areaWidth(x + LLAYOUT_PADDING + (LLAYOUT_PADDING_DIV2 * m_coledgecount[root.colcount]));
+    m_graph->areaHeight(y + LLAYOUT_PADDING + (LLAYOUT_PADDING_DIV2 * m_rowedgecount[root.rowcount]));
 }
 
 void LayeredLayout::computeNodePositions()
 {
-    for(auto& item : m_blocks)
+    for(LLBlock& block : m_blocks)
     {
-        LLBlock& block = item.second;
         block.x = static_cast<float>((m_colx[block.col] + m_colwidth[block.col] + (LLAYOUT_PADDING_DIV2 / 2) * m_coledgecount[block.col + 1]) - (block.width / 2));
 
         if((block.x + block.width) > (m_colx[block.col] + m_colwidth[block.col] + m_colwidth[block.col + 1] + LLAYOUT_PADDING_DIV2 * m_coledgecount[block.col + 1]))
@@ -269,10 +361,8 @@ void LayeredLayout::computeNodePositions()
 
 void LayeredLayout::precomputeEdgeCoordinates()
 {
-    for(auto& item : m_blocks)
+    for(LLBlock& block : m_blocks)
     {
-        LLBlock& block = item.second;
-
         for(LLEdge& edge : block.edges)
         {
             auto start = edge.points[0];
@@ -322,7 +412,7 @@ void LayeredLayout::precomputeEdgeCoordinates()
     }
 }
 
-LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredLayout::EdgesVector &vertedges, Matrix<bool> &edge_valid, LLBlock &start, LLBlock &end)
+LLEdge LayeredLayout::routeEdge(LLBlock &start, LLBlock &end)
 {
     LLEdge edge;
     edge.sourceblock = &start;
@@ -333,12 +423,12 @@ LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredL
 
     while(true)
     {
-        if(!this->isEdgeMarked(vertedges, start.row + 1, start.col + 1, i))
+        if(!m_vertedges.isMarked(start.row + 1, start.col + 1, i))
             break;
         i += 1;
     }
 
-    this->markEdge(vertedges, start.row + 1, start.col + 1, i);
+    m_vertedges.mark(start.row + 1, start.col + 1, i, true);
     edge.addPoint(start.row + 1, start.col + 1);
     edge.startindex = i;
     bool horiz = false;
@@ -361,12 +451,12 @@ LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredL
 
     if(minrow != maxrow)
     {
-        auto checkColumn = [minrow, maxrow, &edge_valid](int column) -> bool {
-            if(column < 0 || column >= static_cast<int>(edge_valid[minrow].size()))
+        auto checkColumn = [minrow, maxrow, this](int column) -> bool {
+            if(column < 0 || column >= m_gridcols)
                 return false;
 
             for(int row = minrow; row < maxrow; row++) {
-                if(!edge_valid[row][column])
+                if(!this->isEdgeValid(row, column))
                     return false;
             }
 
@@ -415,7 +505,7 @@ LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredL
             maxcol = col;
         }
 
-        int index = this->findHorizEdgeIndex(horizedges, start.row + 1, mincol, maxcol);
+        int index = this->findHorizEdgeIndex(start.row + 1, mincol, maxcol);
         edge.addPoint(start.row + 1, col, index);
         horiz = true;
     }
@@ -424,8 +514,8 @@ LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredL
     {
         //Not in same row, need to generate a line for moving to the correct row
         if(col == (start.col + 1))
-            this->markEdge(vertedges, start.row + 1, start.col + 1, i, false);
-        int index = this->findVertEdgeIndex(vertedges, col, minrow, maxrow);
+            m_vertedges.mark(start.row + 1, start.col + 1, i, false);
+        int index = this->findVertEdgeIndex(col, minrow, maxrow);
         if(col == (start.col + 1))
             edge.startindex = index;
         edge.addPoint(end.row, col, index);
@@ -446,7 +536,7 @@ LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredL
             mincol = end.col + 1;
             maxcol = col;
         }
-        int index = this->findHorizEdgeIndex(horizedges, end.row, mincol, maxcol);
+        int index = this->findHorizEdgeIndex(end.row, mincol, maxcol);
         edge.addPoint(end.row, end.col + 1, index);
         horiz = true;
     }
@@ -454,14 +544,14 @@ LLEdge LayeredLayout::routeEdge(LayeredLayout::EdgesVector &horizedges, LayeredL
     //If last line was horizontal, choose the ending edge index for the incoming edge
     if(horiz)
     {
-        int index = this->findVertEdgeIndex(vertedges, end.col + 1, end.row, end.row);
+        int index = this->findVertEdgeIndex(end.col + 1, end.row, end.row);
         edge.points[int(edge.points.size()) - 1].index = index;
     }
 
     return edge;
 }
 
-int LayeredLayout::findHorizEdgeIndex(LayeredLayout::EdgesVector &edges, int row, int mincol, int maxcol) const
+int LayeredLayout::findHorizEdgeIndex(int row, int mincol, int maxcol)
 {
     //Find a valid index
     int i = 0;
@@ -472,7 +562,7 @@ int LayeredLayout::findHorizEdgeIndex(LayeredLayout::EdgesVector &edges, int row
 
         for(int col = mincol; col < maxcol + 1; col++)
         {
-            if(!this->isEdgeMarked(edges, row, col, i))
+            if(!m_horizedges.isMarked(row, col, i))
                 continue;
 
             valid = false;
@@ -487,12 +577,12 @@ int LayeredLayout::findHorizEdgeIndex(LayeredLayout::EdgesVector &edges, int row
 
     //Mark chosen index as used
     for(int col = mincol; col < maxcol + 1; col++)
-        this->markEdge(edges, row, col, i);
+        m_horizedges.mark(row, col, i, true);
 
     return i;
 }
 
-int LayeredLayout::findVertEdgeIndex(LayeredLayout::EdgesVector &edges, int col, int minrow, int maxrow) const
+int LayeredLayout::findVertEdgeIndex(int col, int minrow, int maxrow)
 {
     //Find a valid index
     int i = 0;
@@ -503,7 +593,7 @@ int LayeredLayout::findVertEdgeIndex(LayeredLayout::EdgesVector &edges, int col,
 
         for(int row = minrow; row < maxrow + 1; row++)
         {
-            if(!this->isEdgeMarked(edges, row, col, i))
+            if(!m_vertedges.isMarked(row, col, i))
                 continue;
 
             valid = false;
@@ -518,34 +608,18 @@ int LayeredLayout::findVertEdgeIndex(LayeredLayout::EdgesVector &edges, int col,
 
     //Mark chosen index as used
     for(int row = minrow; row < maxrow + 1; row++)
-        this->markEdge(edges, row, col, i);
+        m_vertedges.mark(row, col, i, true);
 
     return i;
 }
 
-bool LayeredLayout::isEdgeMarked(LayeredLayout::EdgesVector &edges, int row, int col, int index) const
-{
-    if(index >= static_cast<int>(edges[row][col].size()))
-        return false;
-
-    return edges[row][col][index];
-}
-
-void LayeredLayout::markEdge(LayeredLayout::EdgesVector &edges, int row, int col, int index, bool used) const
-{
-    while(static_cast<int>(edges[row][col].size()) <= index)
-        edges[row][col].push_back(false);
-
-    edges[row][col][index] = used;
-}
-
 void LayeredLayout::adjustGraphLayout(LLBlock &block, int col, int row)
 {
     block.col += col;
     block.row += row;
 
     for(const Node& n : block.newoutgoing)
-        this->adjustGraphLayout(m_blocks[n], col, row);
+        this->adjustGraphLayout(this->block(n), col, row);
 }
 
 void LayeredLayout::computeLayout(LLBlock &block)
@@ -559,18 +633,19 @@ void LayeredLayout::computeLayout(LLBlock &block)
     for(size_t i = 0; i < block.newoutgoing.size(); i++)
     {
         const Node& n = block.newoutgoing[i];
-        this->computeLayout(m_blocks[n]);
+        LLBlock& child = this->block(n);
+        this->computeLayout(child);
 
-        if((m_blocks[n].rowcount + 1) > rowcount)
-            rowcount = m_blocks[n].rowcount + 1;
+        if((child.rowcount + 1) > rowcount)
+            rowcount = child.rowcount + 1;
 
-        childcolumn = m_blocks[n].col;
+        childcolumn = child.col;
     }
 
     if(m_layouttype != LayoutType::Wide && block.newoutgoing.size() == 2)
     {
-        LLBlock& left = m_blocks[block.newoutgoing[0]];
-        LLBlock& right = m_blocks[block.newoutgoing[1]];
+        LLBlock& left = this->block(block.newoutgoing[0]);
+        LLBlock& right = this->block(block.newoutgoing[1]);
 
         if(left.newoutgoing.size() == 0)
         {
@@ -604,8 +679,9 @@ void LayeredLayout::computeLayout(LLBlock &block)
     {
         for(const Node& n : block.newoutgoing)
         {
-            this->adjustGraphLayout(m_blocks[n], col, 1);
-            col += m_blocks[n].colcount;
+            LLBlock& child = this->block(n);
+            this->adjustGraphLayout(child, col, 1);
+            col += child.colcount;
         }
 
         if(col >= 2)
@@ -10,10 +10,12 @@
 // - https://github.com/x64dbg/x64dbg/blob/development/src/gui/Src/Gui/DisassemblerGraphView.h
 // - https://github.com/x64dbg/x64dbg/blob/development/src/gui/Src/Gui/DisassemblerGraphView.cpp
 
-#include <unordered_map>
 #include <algorithm>
-#include <deque>
+#include <atomic>
+#include <vector>
+#include "../../types/base_types.h"
 #include "abstractlayout.h"
+#include "layoutcache.h"
 
 namespace REDasm {
 namespace Graphing {
@@ -30,7 +32,7 @@ struct LLPoint
 struct LLEdge
 {
     LLBlock *sourceblock, *targetblock;
-    std::deque<LLPoint> points;
+    std::vector<LLPoint> points;
     int startindex = 0;
 
     Polyline routes;
@@ -50,10 +52,17 @@ struct LLBlock
     LLBlock() { }
     LLBlock(const Node& node, int w, int h) : node(node), width(w), height(h) { }
 
+    void reset(const Node& n, int w, int h) { // Keep allocated buffers around
+        node = n; width = w; height = h;
+        edges.clear(); incoming.clear(); newoutgoing.clear();
+        x = y = 0.0;
+        col = colcount = row = rowcount = 0;
+    }
+
     Node node;
-    std::deque<LLEdge> edges;
-    std::deque<Node> incoming;
-    std::deque<Node> newoutgoing;
+    std::vector<LLEdge> edges;
+    std::vector<Node> incoming;
+    std::vector<Node> newoutgoing;
 
     float x = 0.0, y = 0.0;
     int width = 0, height = 0;
@@ -61,18 +70,36 @@ struct LLBlock
     int row = 0, rowcount = 0;
 };
 
-class LayeredLayout: public AbstractLayout
+class LLEdgeGrid // Row-major grid of edge index bitsets
 {
     public:
-        enum LayoutType { Wide, Medium, Narrow };
+        LLEdgeGrid(): m_rows(0), m_cols(0), m_words(1) { }
+        void reset(int rows, int cols);
+        int extent(int row, int col) const { return m_extents[this->cell(row, col)]; }
+        bool isMarked(int row, int col, int index) const;
+        void mark(int row, int col, int index, bool used);
 
     private:
-        template<typename T> using Matrix = std::deque< std::deque<T> >;
-        using EdgesVector = Matrix< std::deque<bool> >;
+        size_t cell(int row, int col) const { return static_cast<size_t>(row) * m_cols + col; }
+        void grow(size_t words);
+
+    private:
+        int m_rows, m_cols;
+        size_t m_words;
+        std::vector<u64> m_bits;
+        std::vector<int> m_extents; // Highest index touched + 1, for each cell
+};
+
+class LayeredLayout: public AbstractLayout
+{
+    public:
+        enum LayoutType { Wide, Medium, Narrow };
 
     public:
         LayeredLayout(Graph* graph);
         void setLayoutType(int lt);
+        void setCancelled(const std::atomic<bool>* cancelled);
+        bool isCancelled() const;
         virtual bool execute();
 
     private: // Refactored functions
@@ -85,26 +112,33 @@ class LayeredLayout: public AbstractLayout
         void computeRowColumnPositions();
         void computeNodePositions();
         void precomputeEdgeCoordinates();
+        void cacheLayout(const LayoutCache::Key& key) const;
+        bool cancel();
 
     private: // Algorithm functions
-        LLEdge routeEdge(EdgesVector& m_horizedges, EdgesVector& m_vertedges, Matrix<bool>& m_edgevalid, LLBlock& start, LLBlock& end);
-        int findHorizEdgeIndex(EdgesVector& edges, int row, int mincol, int maxcol) const;
-        int findVertEdgeIndex(EdgesVector& edges, int col, int minrow, int maxrow) const;
-        bool isEdgeMarked(EdgesVector& edges, int row, int col, int index) const;
-        void markEdge(EdgesVector& edges, int row, int col, int index, bool used = true) const;
+        LLEdge routeEdge(LLBlock& start, LLBlock& end);
+        int findHorizEdgeIndex(int row, int mincol, int maxcol);
+        int findVertEdgeIndex(int col, int minrow, int maxrow);
+        bool isEdgeValid(int row, int col) const { return m_edgevalid[static_cast<size_t>(row) * m_gridcols + col]; }
         void adjustGraphLayout(LLBlock & block, int col, int row);
         void computeLayout(LLBlock &block);
+        LLBlock& block(const Node& n) { return m_blocks[m_blockindex[n]]; }
 
     private:
-        template<typename T> static void removeFromDeque(std::deque<T>& v, T item) { v.erase(std::remove(v.begin(), v.end(), item), v.end()); }
-        template<typename T> static void initDeque(std::deque<T>& v, size_t size, T value) { v.resize(size); for(size_t i = 0; i < size; i++) v[i] = value; }
-
-    private:
-        std::unordered_map<Node, LLBlock> m_blocks;
-        std::deque<int> m_colx, m_rowy, m_coledgex, m_rowedgey, m_colwidth, m_rowheight, m_coledgecount, m_rowedgecount;
-        std::deque<Node> m_blockorder;
-        EdgesVector m_horizedges, m_vertedges;
-        Matrix<bool> m_edgevalid;
+        template<typename T> static void removeFromVector(std::vector<T>& v, T item) { v.erase(std::remove(v.begin(), v.end(), item), v.end()); }
+        template<typename T> static void initVector(std::vector<T>& v, size_t size, T value) { v.assign(size, value); }
+
+    private: // Working data of a single execute()
+        std::vector<LLBlock> m_blocks;
+        std::vector<size_t> m_blockindex; // Node -> m_blocks
+        std::vector<size_t> m_scanorder;  // m_blocks, in the order makeAcyclic() looks for the next edge
+        std::vector<int> m_colx, m_rowy, m_coledgex, m_rowedgey, m_colwidth, m_rowheight, m_coledgecount, m_rowedgecount;
+        std::vector<Node> m_blockorder;
+        std::vector<char> m_visited;
+        LLEdgeGrid m_horizedges, m_vertedges;
+        std::vector<char> m_edgevalid;
+        const std::atomic<bool>* m_cancelled;
+        int m_gridcols;
         int m_layouttype;
 };
 
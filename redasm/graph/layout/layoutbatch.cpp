@@ -0,0 +1,128 @@
+#include "layoutbatch.h"
+#include "../../support/concurrent/parallel.h"
+#include "../../redasm_api.h"
+
+namespace REDasm {
+namespace Graphing {
+
+LayoutBatch::LayoutBatch(int layouttype): m_pending(0), m_memorylimit(0), m_memoryused(0), m_layouttype(layouttype) { }
+
+size_t LayoutBatch::add(Graph *graph)
+{
+    std::unique_ptr<Item> item(new Item());
+    item->graph = graph;
+    item->cancelled = false;
+    item->state = State::Pending;
+
+    m_items.push_back(std::move(item));
+    return m_items.size() - 1;
+}
+
+void LayoutBatch::cancel(size_t idx)
+{
+    std::lock_guard<std::mutex> lock(m_mutex); // A worker between its wait predicate and its sleep must not miss this
+
+    if(idx < m_items.size())
+        m_items[idx]->cancelled = true;
+
+    m_released.notify_all(); // Wake up workers waiting for memory
+}
+
+void LayoutBatch::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(auto& item : m_items)
+        item->cancelled = true;
+
+    m_released.notify_all();
+}
+
+void LayoutBatch::setMemoryLimit(size_t bytes) { m_memorylimit = bytes; }
+LayoutBatch::State LayoutBatch::state(size_t idx) const { return m_items.at(idx)->state; }
+size_t LayoutBatch::size() const { return m_items.size(); }
+
+bool LayoutBatch::execute()
+{
+    m_pending = m_items.size();
+    m_memoryused = 0;
+
+    Parallel::forEach(m_items.size(), [&](size_t idx) {
+        this->layout(m_items[idx].get());
+        m_pending--;
+        this->reportProgress();
+    });
+
+    for(const auto& item : m_items)
+    {
+        if(item->state != State::Done)
+            return false;
+    }
+
+    return true;
+}
+
+size_t LayoutBatch::estimateMemory(const Graph *graph) { return (graph->nodes().size() * LAYOUT_NODE_COST) + (graph->edges().size() * LAYOUT_EDGE_COST); }
+
+void LayoutBatch::layout(Item *item)
+{
+    if(item->state == State::Done)
+        return;
+
+    size_t amount = LayoutBatch::estimateMemory(item->graph);
+
+    if(!this->acquire(item, amount))
+    {
+        item->state = State::Cancelled;
+        return;
+    }
+
+    item->state = State::Running;
+
+    LayeredLayout ll(item->graph);
+    ll.setLayoutType(m_layouttype);
+    ll.setCancelled(&item->cancelled);
+
+    if(ll.execute())
+        item->state = State::Done;
+    else
+        item->state = item->cancelled ? State::Cancelled : State::Failed;
+
+    this->release(amount);
+}
+
+bool LayoutBatch::acquire(Item *item, size_t amount)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // A graph larger than the whole budget still runs, but alone
+    m_released.wait(lock, [&]() {
+        return item->cancelled || !m_memorylimit || !m_memoryused || ((m_memoryused + amount) <= m_memorylimit);
+    });
+
+    if(item->cancelled)
+        return false;
+
+    m_memoryused += amount;
+    return true;
+}
+
+void LayoutBatch::release(size_t amount)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_memoryused -= amount;
+    }
+
+    m_released.notify_all();
+}
+
+void LayoutBatch::reportProgress()
+{
+    std::lock_guard<std::mutex> lock(m_mutex); // Status callbacks are not reentrant
+    size_t pending = m_pending;
+    REDasm::statusProgress("Computing layouts: " + std::to_string(m_items.size() - pending) + "/" + std::to_string(m_items.size()), pending);
+}
+
+} // namespace Graphing
+} // namespace REDasm
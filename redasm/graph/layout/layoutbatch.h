@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "layeredlayout.h"
+
+#define LAYOUT_NODE_COST 512 // Rough per-node footprint of a LayeredLayout run, in bytes
+#define LAYOUT_EDGE_COST 256 // Rough per-edge footprint (routes, arrows and grid lanes), in bytes
+
+namespace REDasm {
+namespace Graphing {
+
+class LayoutBatch // Lays out many graphs across the worker threads
+{
+    public:
+        enum class State: u8 { Pending, Running, Done, Cancelled, Failed };
+
+    private:
+        struct Item {
+            Graph* graph;
+            std::atomic<bool> cancelled;
+            std::atomic<State> state;
+        };
+
+    public:
+        LayoutBatch(int layouttype = LayeredLayout::Medium);
+        size_t add(Graph* graph);
+        void cancel(size_t idx);
+        void cancelAll();
+        void setMemoryLimit(size_t bytes); // 0: no limit
+        State state(size_t idx) const;
+        size_t size() const;
+        bool execute();                    // Blocks until every graph is done or cancelled
+
+    private:
+        static size_t estimateMemory(const Graph* graph);
+        void layout(Item* item);
+        bool acquire(Item* item, size_t amount);
+        void release(size_t amount);
+        void reportProgress();
+
+    private:
+        std::deque< std::unique_ptr<Item> > m_items;
+        std::mutex m_mutex;
+        std::condition_variable m_released;
+        std::atomic<size_t> m_pending;
+        size_t m_memorylimit, m_memoryused;
+        int m_layouttype;
+};
+
+} // namespace Graphing
+} // namespace REDasm
@@ -0,0 +1,129 @@
+#include "layoutcache.h"
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV_PRIME        0x100000001b3ull
+
+namespace REDasm {
+namespace Graphing {
+
+std::mutex LayoutCache::m_mutex;
+LayoutCache::EntryList LayoutCache::m_entries;
+LayoutCache::EntryIndex LayoutCache::m_index;
+
+LayoutCache::Key LayoutCache::key(const Graph *graph, int layouttype)
+{
+    Key key;
+    key.structure.reserve(3 + (graph->nodes().size() * 3) + (graph->edges().size() * 2));
+    key.structure.push_back(layouttype);
+    key.structure.push_back(graph->root());
+    key.structure.push_back(static_cast<int>(graph->nodes().size()));
+
+    for(const Node& n : graph->nodes())
+    {
+        key.structure.push_back(n);
+        key.structure.push_back(graph->width(n));
+        key.structure.push_back(graph->height(n));
+    }
+
+    for(const Edge& e : graph->edges())
+    {
+        key.structure.push_back(e.source);
+        key.structure.push_back(e.target);
+    }
+
+    key.hash = FNV_OFFSET_BASIS; // FNV-1a over the structure
+
+    for(int v : key.structure)
+    {
+        for(size_t i = 0; i < sizeof(int); i++)
+        {
+            key.hash ^= static_cast<u8>(static_cast<unsigned int>(v) >> (i * 8));
+            key.hash *= FNV_PRIME;
+        }
+    }
+
+    return key;
+}
+
+bool LayoutCache::restore(const Key &key, Graph *graph)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = LayoutCache::find(key);
+
+    if(it == m_index.end())
+        return false;
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    const Layout& layout = it->second->layout;
+
+    for(const auto& item : layout.nodes)
+    {
+        graph->x(item.first, item.second.x);
+        graph->y(item.first, item.second.y);
+        graph->height(item.first, item.second.height);
+    }
+
+    for(const EdgeLayout& edgelayout : layout.edges)
+    {
+        graph->routes(edgelayout.edge, edgelayout.routes);
+        graph->arrow(edgelayout.edge, edgelayout.arrow);
+    }
+
+    graph->areaWidth(layout.areawidth);
+    graph->areaHeight(layout.areaheight);
+    return true;
+}
+
+void LayoutCache::store(const Key &key, Layout &&layout)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = LayoutCache::find(key);
+
+    if(it != m_index.end())
+    {
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    m_entries.push_front({ key, std::move(layout) });
+    m_index.emplace(key.hash, m_entries.begin());
+
+    while(m_entries.size() > LAYOUT_CACHE_SIZE)
+    {
+        auto range = m_index.equal_range(m_entries.back().key.hash);
+
+        for(auto iit = range.first; iit != range.second; iit++)
+        {
+            if(iit->second != std::prev(m_entries.end()))
+                continue;
+
+            m_index.erase(iit);
+            break;
+        }
+
+        m_entries.pop_back();
+    }
+}
+
+void LayoutCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_entries.clear();
+}
+
+LayoutCache::EntryIndex::iterator LayoutCache::find(const Key &key)
+{
+    auto range = m_index.equal_range(key.hash);
+
+    for(auto it = range.first; it != range.second; it++)
+    {
+        if(it->second->key == key)
+            return it;
+    }
+
+    return m_index.end();
+}
+
+} // namespace Graphing
+} // namespace REDasm
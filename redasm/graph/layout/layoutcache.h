@@ -0,0 +1,53 @@
+#pragma once
+
+#include <unordered_map>
+#include <mutex>
+#include <list>
+#include "../../types/base_types.h"
+#include "../graph.h"
+
+#define LAYOUT_CACHE_SIZE 128
+
+namespace REDasm {
+namespace Graphing {
+
+class LayoutCache
+{
+    public:
+        struct Key {
+            u64 hash;
+            std::vector<int> structure; // Layout type, root, node sizes and edges: resolves hash collisions
+            bool operator ==(const Key& k) const { return (hash == k.hash) && (structure == k.structure); }
+        };
+
+        struct EdgeLayout { Edge edge; Polyline routes, arrow; };
+
+        struct Layout {
+            std::vector< std::pair<Node, NodeAttributes> > nodes;
+            std::vector<EdgeLayout> edges;
+            int areawidth, areaheight;
+        };
+
+    private:
+        struct Entry { Key key; Layout layout; };
+        typedef std::list<Entry> EntryList;
+        typedef std::unordered_multimap<u64, EntryList::iterator> EntryIndex;
+
+    public:
+        LayoutCache() = delete;
+        static Key key(const Graph* graph, int layouttype);
+        static bool restore(const Key& key, Graph* graph);
+        static void store(const Key& key, Layout&& layout);
+        static void clear();
+
+    private:
+        static EntryIndex::iterator find(const Key& key);
+
+    private:
+        static std::mutex m_mutex;
+        static EntryList m_entries; // Most recently used first
+        static EntryIndex m_index;
+};
+
+} // namespace Graphing
+} // namespace REDasm
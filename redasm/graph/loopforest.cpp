@@ -0,0 +1,104 @@
+#include "loopforest.h"
+#include <algorithm>
+#include <map>
+
+namespace REDasm {
+namespace Graphing {
+
+LoopForest::LoopForest(const Graph *graph, const std::shared_ptr<const DominatorTree> &dominators): m_dominators(dominators)
+{
+    std::map<Node, Loop> headers; // Back edges sharing the header belong to the same loop
+    Node maxnode = 0;
+
+    for(const Node& n : graph->nodes())
+        maxnode = std::max(maxnode, n);
+
+    for(const Edge& e : graph->edges())
+    {
+        if(!this->isBackEdge(e))
+            continue;
+
+        Loop& loop = headers[e.target];
+        loop.header = e.target;
+        loop.backedges.push_back(e);
+    }
+
+    std::vector<char> inloop(static_cast<size_t>(maxnode) + 1, false);
+
+    for(auto& item : headers)
+    {
+        Loop& loop = item.second;
+        NodeList pending;
+
+        inloop[loop.header] = true;
+        loop.body.push_back(loop.header);
+
+        for(const Edge& e : loop.backedges)
+            pending.push_back(e.source);
+
+        while(!pending.empty()) // Walk predecessors backwards from the latches up to the header
+        {
+            Node n = pending.back();
+            pending.pop_back();
+
+            if(inloop[n] || !m_dominators->reachable(n))
+                continue;
+
+            inloop[n] = true;
+            loop.body.push_back(n);
+
+            for(const Edge& e : graph->incoming(n))
+                pending.push_back(e.source);
+        }
+
+        for(const Node& n : loop.body)
+            inloop[n] = false;
+
+        std::sort(loop.body.begin(), loop.body.end());
+        m_loops.push_back(std::move(loop));
+    }
+
+    // Outer loops first, so inner ones overwrite the node mapping
+    std::stable_sort(m_loops.begin(), m_loops.end(), [](const Loop& l1, const Loop& l2) { return l1.body.size() > l2.body.size(); });
+
+    m_nodeloop.assign(inloop.size(), -1);
+    m_headerloop.assign(inloop.size(), -1);
+
+    for(size_t i = 0; i < m_loops.size(); i++)
+    {
+        Loop& loop = m_loops[i];
+        loop.parent = m_nodeloop[loop.header];
+        loop.depth = (loop.parent == -1) ? 1 : (m_loops[loop.parent].depth + 1);
+        m_headerloop[loop.header] = static_cast<int>(i);
+
+        for(const Node& n : loop.body)
+            m_nodeloop[n] = static_cast<int>(i);
+    }
+}
+
+const Loop *LoopForest::loop(const Node &n) const
+{
+    if((n < 0) || (static_cast<size_t>(n) >= m_nodeloop.size()) || (m_nodeloop[n] == -1))
+        return nullptr;
+
+    return &m_loops[m_nodeloop[n]];
+}
+
+const Loop *LoopForest::header(const Node &n) const
+{
+    if((n < 0) || (static_cast<size_t>(n) >= m_headerloop.size()) || (m_headerloop[n] == -1))
+        return nullptr;
+
+    return &m_loops[m_headerloop[n]];
+}
+
+bool LoopForest::isBackEdge(const Edge &e) const { return m_dominators->dominates(e.target, e.source); }
+
+int LoopForest::depth(const Node &n) const
+{
+    const Loop* l = this->loop(n);
+    return l ? l->depth : 0;
+}
+
+} // namespace Graphing
+} // namespace REDasm
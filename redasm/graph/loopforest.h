@@ -0,0 +1,34 @@
+#pragma once
+
+#include <memory>
+#include "dominatortree.h"
+
+namespace REDasm {
+namespace Graphing {
+
+struct Loop
+{
+    Node header;
+    NodeList body;      // Header included, sorted
+    EdgeList backedges; // Latch -> header
+    int parent, depth;  // parent: index in LoopForest, -1 for outermost loops
+};
+
+class LoopForest // Natural loops, nested by containment
+{
+    public:
+        LoopForest(const Graph* graph, const std::shared_ptr<const DominatorTree>& dominators);
+        const std::vector<Loop>& loops() const { return m_loops; }
+        const Loop* loop(const Node& n) const;                // Innermost loop containing n
+        const Loop* header(const Node& n) const;              // Loop headed by n
+        bool isBackEdge(const Edge& e) const;
+        int depth(const Node& n) const;                       // 0: not in a loop
+
+    private:
+        std::shared_ptr<const DominatorTree> m_dominators;
+        std::vector<Loop> m_loops;
+        std::vector<int> m_nodeloop, m_headerloop;            // Indexed by Node, -1: none
+};
+
+} // namespace Graphing
+} // namespace REDasm
@@ -49,9 +49,9 @@ LOADER_PLUGIN_TEST(N64Loader, N64RomHeader)
     if(!N64Loader::checkMediaType(header) || !N64Loader::checkCountryCode(header))
         return false;
 
-    if(!swappedbuffer.empty()) // Swap all
+    if(!swappedbuffer.empty()) // Swap the checksummed area only
     {
-        Buffer::swapEndianness<u16>(request.view.buffer(), &swappedbuffer);
+        Buffer::swapEndianness<u16>(request.view.buffer(), &swappedbuffer, N64_ROM_CHECKSUM_START + N64_ROM_CHECKSUM_LENGTH);
         header = static_cast<const N64RomHeader*>(swappedbuffer);
 
         BufferView swappedview = swappedbuffer.view();
@@ -68,7 +68,15 @@ Analyzer *N64Loader::createAnalyzer(DisassemblerAPI *disassembler) const { retur
 void N64Loader::load()
 {
     if(m_header->magic_0 != N64_MAGIC_BE_B1)
-        Buffer::swapEndianness<u16>(m_buffer.get());
+    {
+        if(!m_buffer->makeWritable())
+        {
+            REDasm::problem("Cannot swap ROM's endianness: the buffer is read-only");
+            return;
+        }
+
+        Buffer::swapEndianness<u16>(m_buffer.get()); // In place, file mappings are copy-on-write
+    }
 
     m_document->segment("KSEG0", N64_ROM_HEADER_SIZE, this->getEP(), m_buffer->size() - N64_ROM_HEADER_SIZE, SegmentType::Code | SegmentType::Data);
     // TODO: map other segments
@@ -1,4 +1,5 @@
 #include "borland_version.h"
+#include "../../../support/search/ahocorasick.h"
 #include <algorithm>
 
 namespace REDasm {
@@ -12,30 +13,28 @@ std::string BorlandVersion::getSignature() const
     if(IS_PRE_V4(m_packageinfo))
         return "delphi3";
 
-    if(this->contains("System.SysUtils"))
-        return "delphiXE2_6";
+    static const std::vector< std::pair<std::string, std::string> > units = { // By priority
+        { "System.SysUtils", "delphiXE2_6" },
+        { "ExcUtils",        "delphiXE"    },
+        { "StrUtils",        "delphi9_10"  },
+        { "ImageHlp",        "delphi6"     },
+        { "SysInit",         "delphi7"     },
+    };
 
-    if(this->contains("ExcUtils"))
-        return "delphiXE";
+    Search::AhoCorasick matcher;
 
-    if(this->contains("StrUtils"))
-        return "delphi9_10";
+    for(const auto& unit : units)
+        matcher.add(unit.first);
 
-    if(this->contains("ImageHlp"))
-        return "delphi6";
+    matcher.build();
+    size_t best = units.size();
 
-    if(this->contains("SysInit"))
-        return "delphi7";
+    matcher.scan(reinterpret_cast<const u8*>(m_packageinfo), m_size, [&best](size_t idx, u64) -> bool {
+        best = std::min(best, idx);
+        return best > 0;
+    });
 
-    return std::string();
-}
-
-bool BorlandVersion::contains(const std::string &s) const
-{
-    const char* fs = s.data();
-    char* p = reinterpret_cast<char*>(m_packageinfo);
-
-    return static_cast<size_t>(std::search(p, p + m_size, fs, fs + s.size()) - p) < m_size;
+    return (best < units.size()) ? units[best].second : std::string();
 }
 
 } // namespace REDasm
@@ -13,9 +13,6 @@ class BorlandVersion
         bool isCpp() const;
         std::string getSignature() const;
 
-    private:
-        bool contains(const std::string& s) const;
-
     private:
         PackageInfoHeader* m_packageinfo;
         PEResources::ResourceItem m_resourceitem;
@@ -111,6 +111,9 @@ void AssemblerAlgorithm::done(address_t address) { m_done.insert(address); }
 
 void AssemblerAlgorithm::onDecoded(const InstructionPtr &instruction)
 {
+    if(instruction->is(InstructionType::Call))
+        m_disassembler->callGraph()->pushCallSite(instruction->address);
+
     if(instruction->is(InstructionType::Branch))
     {
         this->loadTargets(instruction);
@@ -33,33 +33,6 @@ bool Emulator::setTarget(const InstructionPtr &instruction)
    return true;
 }
 
-MemoryBuffer *Emulator::getSegmentMemory(address_t address, offset_t *offset)
-{
-    for(auto it = m_memory.begin(); it != m_memory.end(); it++)
-    {
-        const Segment* segment = it->first;
-
-        if(!segment->contains(address))
-            continue;
-
-        *offset = (address - segment->address); // Relative segment offset
-        return it->second.get();
-    }
-
-    return nullptr;
-}
-
-BufferView Emulator::getMemory(address_t address)
-{
-    offset_t offset = 0;
-    MemoryBuffer* buffer = this->getSegmentMemory(address, &offset);
-
-    if(!buffer || buffer->empty())
-        return BufferView();
-
-    return buffer->view(offset);
-}
-
 BufferView Emulator::getStack(offset_t sp) { return m_stack->view(sp); }
 
 void Emulator::remap()
@@ -77,19 +50,18 @@ void Emulator::remap()
                     " @ " + REDasm::hex(segment.address) + ", " +
                     " size: " + REDasm::hex(segment.size()));
 
-        if(!segment.is(SegmentType::Bss))
-        {
-            BufferView view = loader->view(segment.address);
-
-            if(segment.size() > static_cast<s64>(view.size()))
-                return;
+        if(segment.empty())
+            continue;
 
-            auto buffer = std::make_unique<MemoryBuffer>();
-            view.copyTo(buffer.get());
-            m_memory[&segment] = std::move(buffer);
+        if(segment.is(SegmentType::Bss)) // Zero filled on first access
+        {
+            m_memory.map(segment.address, segment.size());
+            continue;
         }
-        else
-            m_memory[&segment] = std::make_unique<MemoryBuffer>(segment.size(), 0);
+
+        BufferView view = loader->view(segment.address); // Not copied, written pages are private to the emulator
+        u64 datasize = view.eob() ? 0 : std::min(static_cast<u64>(std::max<s64>(segment.rawSize(), 0)), view.size());
+        m_memory.map(segment.address, segment.size(), view.data(), datasize);
     }
 }
 
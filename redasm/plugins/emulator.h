@@ -2,6 +2,7 @@
 
 #include "../disassembler/disassemblerapi.h"
 #include "../types/buffer/memorybuffer.h"
+#include "../emulator/emulator_memory.h"
 #include "../support/dispatcher.h"
 
 #define EMULATE_INSTRUCTION(id, callback) m_dispatcher[id] = std::bind(callback, this, std::placeholders::_1)
@@ -13,7 +14,6 @@ class Emulator
 {
     private:
         typedef Dispatcher<instruction_id_t, const InstructionPtr&> DispatcherType;
-        typedef std::unordered_map< const Segment*, std::unique_ptr<MemoryBuffer> > MappedMemory;
 
     public:
         Emulator(DisassemblerAPI* disassembler);
@@ -22,11 +22,10 @@ class Emulator
         virtual bool hasError() const = 0;
         virtual bool read(const Operand* op, u64* value) = 0;
         virtual bool displacement(const Operand* op, u64* value) = 0;
+        virtual Emulator* fork() const = 0; // Same state, diverges independently
 
     protected:
         virtual bool setTarget(const InstructionPtr& instruction);
-        MemoryBuffer* getSegmentMemory(address_t address, offset_t* offset);
-        BufferView getMemory(address_t address);
         BufferView getStack(offset_t sp);
 
     private:
@@ -36,7 +35,7 @@ class Emulator
         InstructionPtr m_currentinstruction;
         DisassemblerAPI* m_disassembler;
         DispatcherType m_dispatcher;
-        MappedMemory m_memory;
+        EmulatorMemory m_memory;
         std::unique_ptr<MemoryBuffer> m_stack;
 };
 
@@ -3,6 +3,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <vector>
+#include <mutex>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -25,6 +26,7 @@ const std::string Context::dirSeparator = "\\";
 const std::string Context::dirSeparator = "/";
 #endif
 
+std::recursive_mutex &Context::reportMutex() { static std::recursive_mutex mutex; return mutex; }
 bool Context::hasProblems() { return !m_problems.empty(); }
 size_t Context::problemsCount() { return m_problems.size(); }
 const ProblemList &Context::problems() { return m_problems; }
@@ -34,6 +36,9 @@ void Context::problem(const std::string &s)
     if(Context::settings.ignoreproblems)
         return;
 
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
     auto it = m_uproblems.find(s);
 
     if(it != m_uproblems.end())
@@ -4,6 +4,7 @@
 #include <functional>
 #include <memory>
 #include <deque>
+#include <mutex>
 #include <set>
 #include <chrono>
 #include <string>
@@ -40,6 +41,7 @@ struct Context
     static const LIBREDASM_EXPORT std::string dirSeparator;
     static const LIBREDASM_EXPORT std::chrono::milliseconds debounceTimeout;
 
+    static std::recursive_mutex& reportMutex(); // Serializes log and status callbacks, they run from worker threads too
     static bool hasProblems();
     static size_t problemsCount();
     static const ProblemList& problems();
@@ -6,9 +6,10 @@
 
 namespace REDasm {
 
-JobsPool::JobsPool(): m_running(true)
+JobsPool::JobsPool(size_t concurrency): m_concurrency(concurrency), m_running(true)
 {
-    m_concurrency = std::thread::hardware_concurrency();
+    if(!m_concurrency)
+        m_concurrency = std::thread::hardware_concurrency();
 
     if(!m_concurrency || REDasm::Context::sync())
         m_concurrency = 1;
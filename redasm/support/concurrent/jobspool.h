@@ -13,7 +13,7 @@ class JobsPool
         Event<Job*> stateChanged;
 
     public:
-        JobsPool();
+        JobsPool(size_t concurrency = 0); // 0: one job per hardware thread
         ~JobsPool();
         size_t concurrency() const;
         size_t activeCount() const;
@@ -0,0 +1,64 @@
+#include "parallel.h"
+#include "../../redasm_context.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace REDasm {
+namespace Parallel {
+
+namespace {
+
+thread_local bool t_worker = false; // Nested loops run serially: the outer one already uses every core
+
+} // namespace
+
+size_t concurrency()
+{
+    if(REDasm::Context::sync())
+        return 1;
+
+    size_t c = std::thread::hardware_concurrency();
+    return c ? c : 1;
+}
+
+void forEach(size_t count, const IndexCallback &cb, size_t maxconcurrency)
+{
+    size_t c = std::min(Parallel::concurrency(), count);
+
+    if(maxconcurrency)
+        c = std::min(c, maxconcurrency);
+
+    if((c <= 1) || t_worker)
+    {
+        for(size_t i = 0; i < count; i++)
+            cb(i);
+
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+
+    auto worker = [&]() {
+        bool wasworker = t_worker;
+        t_worker = true;
+
+        for(size_t i = next++; i < count; i = next++)
+            cb(i);
+
+        t_worker = wasworker;
+    };
+
+    for(size_t i = 1; i < c; i++)
+        threads.emplace_back(worker);
+
+    worker(); // The calling thread takes part too
+
+    for(std::thread& t : threads)
+        t.join();
+}
+
+} // namespace Parallel
+} // namespace REDasm
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <functional>
+#include <cstddef>
+
+namespace REDasm {
+namespace Parallel {
+
+typedef std::function<void(size_t)> IndexCallback;
+
+size_t concurrency();
+void forEach(size_t count, const IndexCallback& cb, size_t maxconcurrency = 0); // Blocks until cb(0) ... cb(count - 1) are done, 0: no limit
+
+} // namespace Parallel
+} // namespace REDasm
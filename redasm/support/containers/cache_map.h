@@ -4,6 +4,9 @@
 #include <fstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <memory>
+#include <vector>
+#include <mutex>
 #include "../../types/base_types.h"
 
 namespace REDasm {
@@ -14,6 +17,7 @@ template<typename Key, typename Value> class cache_map // Use STL's coding style
         typedef cache_map<Key, Value> type;
         typedef std::unordered_map<Key, std::streamoff> offset_map;
         typedef typename offset_map::iterator offset_iterator;
+        typedef std::unique_ptr<std::fstream> stream_ptr;
 
     public:
         class iterator: public std::iterator<std::random_access_iterator_tag, Value> {
@@ -52,13 +56,19 @@ template<typename Key, typename Value> class cache_map // Use STL's coding style
         Value operator[](const Key& key);
 
     private:
+        stream_ptr acquireReader();
+        void releaseReader(stream_ptr reader);
         static std::string generateFilePath();
 
     private:
         static std::unordered_set<std::string> m_activenames;
+        static std::mutex m_activenamesmutex; // Documents are created from worker threads too (SignatureBuilder)
         std::string m_filepath;
         offset_map m_offsets;
         std::fstream m_file;
+        std::vector<stream_ptr> m_readers; // Idle read streams, each concurrent reader checks one out
+        std::mutex m_mutex;
+        bool m_dirty;
 };
 
 } // namespace REDasm
@@ -11,8 +11,9 @@
 namespace REDasm {
 
 template<typename Key, typename Value> std::unordered_set<std::string> cache_map<Key, Value>::m_activenames;
+template<typename Key, typename Value> std::mutex cache_map<Key, Value>::m_activenamesmutex;
 
-template<typename Key, typename Value> cache_map<Key, Value>::cache_map(): m_filepath(generateFilePath())
+template<typename Key, typename Value> cache_map<Key, Value>::cache_map(): m_filepath(generateFilePath()), m_dirty(false)
 {
     m_file.exceptions(std::fstream::failbit);
     m_file.open(m_filepath, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
@@ -23,27 +24,33 @@ template<typename Key, typename Value> cache_map<Key, Value>::cache_map(): m_fil
 
 template<typename Key, typename Value> cache_map<Key, Value>::~cache_map()
 {
-    m_activenames.erase(m_filepath);
+    m_readers.clear();
 
-    if(!m_file.is_open())
-        return;
+    if(m_file.is_open())
+    {
+        m_file.close();
+        std::remove(m_filepath.c_str());
+    }
 
-    m_file.close();
-    std::remove(m_filepath.c_str());
+    std::lock_guard<std::mutex> lock(m_activenamesmutex); // Release the name only after the file is gone
+    m_activenames.erase(m_filepath);
 }
 
 template<typename Key, typename Value> u64 cache_map<Key, Value>::size() const { return m_offsets.size(); }
 
 template<typename Key, typename Value> void cache_map<Key, Value>::commit(const Key& key, const Value &value)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_file.seekp(0, std::ios::end); // Ignore old key -> value reference, if any
     m_offsets[key] = m_file.tellp();
 
     Serializer<Value>::write(m_file, value);
+    m_dirty = true;
 }
 
 template<typename Key, typename Value> void cache_map<Key, Value>::erase(const cache_map<Key, Value>::iterator &it)
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     auto oit = m_offsets.find(it.key);
 
     if(oit == m_offsets.end())
@@ -60,19 +67,58 @@ template<typename Key, typename Value> Value cache_map<Key, Value>::value(const
         return Value();
 
     Value value;
+    stream_ptr reader = this->acquireReader(); // Seek + read on a private stream, readers don't wait for each other
 
-    auto v = m_file.rdstate();
-    m_file.seekg(it->second, std::ios::beg);
-    v = m_file.rdstate();
+    if(!reader)
+        return value;
 
-    Serializer<Value>::read(m_file, value);
+    reader->seekg(it->second, std::ios::beg);
+    Serializer<Value>::read(*reader, value);
+    this->releaseReader(std::move(reader));
     return value;
 }
 
 template<typename Key, typename Value> Value cache_map<Key, Value>::operator[](const Key& key) { return this->value(key); }
 
+template<typename Key, typename Value> typename cache_map<Key, Value>::stream_ptr cache_map<Key, Value>::acquireReader()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_dirty) // Make pending writes visible to the read streams
+    {
+        m_file.flush();
+        m_dirty = false;
+    }
+
+    if(!m_readers.empty())
+    {
+        stream_ptr reader = std::move(m_readers.back());
+        m_readers.pop_back();
+        reader->clear();
+        return reader;
+    }
+
+    stream_ptr reader(new std::fstream(m_filepath, std::ios::in | std::ios::binary));
+
+    if(!reader->is_open())
+    {
+        REDasm::log("Cannot read cache @ " + REDasm::quoted(m_filepath));
+        return nullptr;
+    }
+
+    reader->exceptions(std::fstream::failbit);
+    return reader;
+}
+
+template<typename Key, typename Value> void cache_map<Key, Value>::releaseReader(stream_ptr reader)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readers.push_back(std::move(reader));
+}
+
 template<typename Key, typename Value> std::string cache_map<Key, Value>::generateFilePath()
 {
+    std::lock_guard<std::mutex> lock(m_activenamesmutex);
     std::string filepath = REDasm::makePath(Context::settings.tempPath, CACHE_FILE_NAME(0));
     auto it = m_activenames.find(filepath);
 
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <functional>
+#include <map>
+
+namespace REDasm {
+
+template< typename Key, typename Value, typename Comparator = std::less<Key> > class interval_map // Use STL's coding style for this type
+{
+    public:
+        struct interval { Key start, end; Value value; }; // [start, end]
+
+    private:
+        typedef std::map<Key, interval, Comparator> container_type;
+
+    public:
+        typedef typename container_type::iterator iterator;
+        typedef typename container_type::const_iterator const_iterator;
+        typedef typename container_type::size_type size_type;
+
+    public:
+        interval_map() = default;
+        size_t size() const { return m_intervals.size(); }
+        bool empty() const { return m_intervals.empty(); }
+        iterator begin() { return m_intervals.begin(); }
+        iterator end() { return m_intervals.end(); }
+        const_iterator begin() const { return m_intervals.begin(); }
+        const_iterator end() const { return m_intervals.end(); }
+        void clear() { m_intervals.clear(); }
+        iterator erase(const_iterator it) { return m_intervals.erase(it); }
+        size_t erase(const Key& start) { return m_intervals.erase(start); }
+
+        bool insert(const Key& start, const Key& end, const Value& value) {
+            Comparator comparator;
+
+            if(comparator(end, start) || (this->find(start) != this->end()))
+                return false;
+
+            auto it = m_intervals.upper_bound(start);
+
+            if((it != m_intervals.end()) && !comparator(end, it->first)) // Overlaps the next interval
+                return false;
+
+            m_intervals.emplace_hint(it, start, interval{ start, end, value });
+            return true;
+        }
+
+        const_iterator find(const Key& key) const {
+            auto it = m_intervals.upper_bound(key);
+
+            if(it == m_intervals.begin())
+                return m_intervals.end();
+
+            it--;
+            return Comparator()(it->second.end, key) ? m_intervals.end() : it;
+        }
+
+        iterator find(const Key& key) {
+            auto it = m_intervals.upper_bound(key);
+
+            if(it == m_intervals.begin())
+                return m_intervals.end();
+
+            it--;
+            return Comparator()(it->second.end, key) ? m_intervals.end() : it;
+        }
+
+        template<typename Predicate> void erase_if(const Predicate& predicate) {
+            for(auto it = m_intervals.begin(); it != m_intervals.end(); ) {
+                if(predicate(it->second))
+                    it = m_intervals.erase(it);
+                else
+                    it++;
+            }
+        }
+
+    private:
+        container_type m_intervals;
+};
+
+} // namespace REDasm
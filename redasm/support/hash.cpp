@@ -0,0 +1,87 @@
+#include "hash.h"
+#include <algorithm>
+#include <numeric>
+
+#define CRC16_POLYNOMIAL 0x1021
+
+namespace REDasm {
+namespace Hash {
+
+namespace {
+
+struct CRC16Table
+{
+    u16 t[8][256]; // t[k][b]: byte b followed by k zero bytes
+
+    CRC16Table() {
+        for(u16 b = 0; b < 256; b++) {
+            u16 crc = static_cast<u16>(b << 8);
+
+            for(int i = 0; i < 8; i++)
+                crc = (crc & 0x8000) ? static_cast<u16>((crc << 1) ^ CRC16_POLYNOMIAL) : static_cast<u16>(crc << 1);
+
+            t[0][b] = crc;
+        }
+
+        for(int k = 1; k < 8; k++) {
+            for(u16 b = 0; b < 256; b++)
+                t[k][b] = static_cast<u16>((t[k - 1][b] << 8) ^ t[0][t[k - 1][b] >> 8]);
+        }
+    }
+};
+
+const CRC16Table& crc16Table() { static const CRC16Table table; return table; }
+
+} // namespace
+
+u16 crc16(const u8 *data, u64 length)
+{
+    const CRC16Table& table = crc16Table();
+    u16 crc = 0xFFFF;
+
+    for( ; length >= 8; data += 8, length -= 8)
+    {
+        crc = table.t[7][data[0] ^ (crc >> 8)] ^ table.t[6][data[1] ^ (crc & 0xFF)] ^
+              table.t[5][data[2]] ^ table.t[4][data[3]] ^ table.t[3][data[4]] ^
+              table.t[2][data[5]] ^ table.t[1][data[6]] ^ table.t[0][data[7]];
+    }
+
+    while(length--)
+        crc = static_cast<u16>(crc << 8) ^ table.t[0][(crc >> 8) ^ *data++];
+
+    return crc;
+}
+
+std::vector<u16> crc16(const BufferView &view, const Slices &slices)
+{
+    std::vector<u16> result(slices.size());
+
+    auto checksum = [&view](const Slice& slice) -> u16 {
+        if((slice.offset > view.size()) || (slice.size > (view.size() - slice.offset)))
+            return crc16(static_cast<const u8*>(nullptr), 0);
+
+        return crc16(view.data() + slice.offset, slice.size);
+    };
+
+    // Walk the buffer forwards: slices close to each other share cache lines.
+    // Callers usually pass them in offset order already, the sort is skipped then
+    if(std::is_sorted(slices.begin(), slices.end(), [](const Slice& s1, const Slice& s2) { return s1.offset < s2.offset; }))
+    {
+        for(size_t i = 0; i < slices.size(); i++)
+            result[i] = checksum(slices[i]);
+
+        return result;
+    }
+
+    std::vector<size_t> order(slices.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&slices](size_t i1, size_t i2) { return slices[i1].offset < slices[i2].offset; });
+
+    for(size_t idx : order)
+        result[idx] = checksum(slices[idx]);
+
+    return result;
+}
+
+} // namespace Hash
+} // namespace REDasm
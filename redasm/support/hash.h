@@ -7,24 +7,15 @@
 namespace REDasm {
 namespace Hash {
 
-template<typename T> u16 crc16(const T* data, u64 length)
-{
-    u8 x;
-    u16 crc = 0xFFFF;
-    const u8* bdata = reinterpret_cast<const u8*>(data);
+struct Slice { u64 offset, size; };
+typedef std::vector<Slice> Slices;
 
-    while(length--)
-    {
-        x = crc >> 8 ^ *bdata++;
-        x ^= x >> 4;
-        crc = (crc << 8) ^ static_cast<u16>(x << 12) ^ static_cast<u16>(x << 5) ^ static_cast<u16>(x);
-    }
+u16 crc16(const u8* data, u64 length); // CRC-16/CCITT-FALSE, slicing-by-8
+std::vector<u16> crc16(const BufferView& view, const Slices& slices); // Out of range slices hash as empty
 
-    return crc;
-}
-
-inline u16 crc16(const BufferView& br) { return crc16(&br, br.size()); }
-inline u16 crc16(const BufferView& br, u64 length) { return crc16(&br, std::min(br.size(), length)); }
+template<typename T> u16 crc16(const T* data, u64 length) { return crc16(reinterpret_cast<const u8*>(data), length); }
+inline u16 crc16(const BufferView& br) { return crc16(br.data(), br.size()); }
+inline u16 crc16(const BufferView& br, u64 length) { return crc16(br.data(), std::min(br.size(), length)); }
 inline u16 crc16(const std::string& s) { return crc16(s.data(), s.size()); }
 template<typename T> inline u16 crc16(const std::string& s) { return crc16(s.data(), s.size()); }
 template<typename T, typename A> u16 crc16(const std::vector<T, A>& v) { return crc16(v.data(), v.size()); }
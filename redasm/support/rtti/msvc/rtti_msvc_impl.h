@@ -2,6 +2,9 @@
 #include "../../../disassembler/disassemblerapi.h"
 #include "../../../loaders/pe/pe.h"
 #include "../../symbolize.h"
+#include "../../search/ahocorasick.h"
+#include "../../search/parallelsearch.h"
+#include <vector>
 
 #if _MSC_VER
     #pragma warning(disable: 4146)
@@ -153,83 +156,97 @@ template<typename T> void RTTIMsvc<T>::searchTypeDescriptors()
         if(view.eob())
             continue;
 
-        auto res = view.find<char>(RTTI_MSVC_CLASS_DESCRIPTOR_PREFIX);
+        const std::string prefix = RTTI_MSVC_CLASS_DESCRIPTOR_PREFIX;
+        Search::Offsets offsets = Search::parallelFindAll(view, reinterpret_cast<const u8*>(prefix.data()), prefix.size());
 
-        while(res.hasNext())
+        for(u64 offset : offsets)
         {
-            const RTTITypeDescriptor* rttitype = RTTI_MSVC_TYPE_DESCRIPTOR(res.result);
+            const RTTITypeDescriptor* rttitype = RTTI_MSVC_TYPE_DESCRIPTOR(reinterpret_cast<const char*>(view.data() + offset));
             address_t rttiaddress = m_loader->addressof(rttitype);
             REDasm::statusAddress("Searching RTTITypeDescriptors in " + REDasm::quoted(segment->name), rttiaddress);
 
             if(m_document->segment(rttitype->pVFTable))
             {
                 REDasm::symbolize<RTTITypeDescriptor>(m_disassembler, rttiaddress, objectName(rttitype) + "::rtti_type_descriptor");
-                m_rttitypes.emplace(segment->address + res.position - RTTI_MSVC_FIXUP, rttitype);
+                m_rttitypes.emplace(segment->address + offset - RTTI_MSVC_FIXUP, rttitype);
             }
-
-            res = res.next();
         }
     }
 }
 
 template<typename T> void RTTIMsvc<T>::searchCompleteObjects()
 {
+    const auto* peformat = static_cast<const PE64Loader*>(m_loader);
     RTTICompleteObjectLocatorSearch searchobj = { this->rttiSignature(), 0, 0, 0 };
+    Search::AhoCorasick matcher;
 
     for(const auto& item : m_rttitypes)
     {
-        const auto* peformat = static_cast<const PE64Loader*>(m_loader);
-
         if(REDasm::bitscount<T>::value == 64)
             searchobj.pTypeDescriptor = static_cast<u32>(peformat->vaToRva(item.first));
         else
             searchobj.pTypeDescriptor = static_cast<u32>(item.first);
 
-        for(const Segment* segment : m_segments)
-        {
-            BufferView view = m_loader->viewSegment(segment);
-            auto res = view.find<RTTICompleteObjectLocatorSearch>(&searchobj);
+        matcher.add(&searchobj);
+    }
 
-            if(!res.hasNext())
-                continue;
+    matcher.build();
+    std::vector<bool> found(matcher.size(), false);
+    size_t remaining = matcher.size();
 
-            REDasm::statusProgress("Searching RTTICompleteObjectLocators in " + REDasm::quoted(segment->name), m_loader->address(res.position));
-            m_rttiobjects.emplace(reinterpret_cast<const RTTICompleteObjectLocator*>(res.result), segment->address + res.position);
+    for(const Segment* segment : m_segments) // One pass per segment, the first segment that matches wins
+    {
+        if(!remaining)
             break;
-        }
+
+        BufferView view = m_loader->viewSegment(segment);
+        REDasm::status("Searching RTTICompleteObjectLocators in " + REDasm::quoted(segment->name));
+
+        matcher.scan(view, [&](size_t idx, u64 offset) -> bool {
+            if(found[idx])
+                return true;
+
+            found[idx] = true;
+            remaining--;
+            m_rttiobjects.emplace(reinterpret_cast<const RTTICompleteObjectLocator*>(view.data() + offset), segment->address + offset);
+            return remaining > 0;
+        });
     }
 }
 
 template<typename T> void RTTIMsvc<T>::searchVTables()
 {
+    std::vector<const RTTICompleteObjectLocator*> rttiobjects;
+    Search::AhoCorasick matcher;
+
     for(const auto& item : m_rttiobjects)
     {
-        const RTTICompleteObjectLocator* rttiobject = item.first;
-        REDasm::status("Searching VTables for " + REDasm::quoted(objectName(rttiobject)));
-
-        for(const Segment* segment : m_segments)
-        {
-            BufferView view = m_loader->viewSegment(segment);
-            auto res = view.find(reinterpret_cast<const T*>(&item.second));
-            bool found = false;
+        T rttiobjectaddress = static_cast<T>(item.second);
+        matcher.add(&rttiobjectaddress);
+        rttiobjects.push_back(item.first);
+    }
 
-            while(res.hasNext())
-            {
-                const RTTICompleteObjectLocator* foundrttiobject = m_loader->addrpointer<RTTICompleteObjectLocator>(*res.result);
+    matcher.build();
+    std::vector<bool> found(matcher.size(), false);
+    size_t remaining = matcher.size();
 
-                if(rttiobject != foundrttiobject)
-                    res = res.next();
+    for(const Segment* segment : m_segments)
+    {
+        if(!remaining)
+            break;
 
-                found = true;
-                break;
-            }
+        BufferView view = m_loader->viewSegment(segment);
+        REDasm::status("Searching VTables in " + REDasm::quoted(segment->name));
 
-            if(!found)
-                continue;
+        matcher.scan(view, [&](size_t idx, u64 offset) -> bool {
+            if(found[idx])
+                return true;
 
-            m_rttivtables.emplace(item.first, m_loader->pointer<T>(segment->offset + res.position));
-            break;
-        }
+            found[idx] = true;
+            remaining--;
+            m_rttivtables.emplace(rttiobjects[idx], m_loader->pointer<T>(segment->offset + offset));
+            return remaining > 0;
+        });
     }
 }
 
@@ -0,0 +1,207 @@
+#include "ahocorasick.h"
+#include <algorithm>
+#include <limits>
+#include <deque>
+
+#define AC_NO_STATE std::numeric_limits<u32>::max()
+
+namespace REDasm {
+namespace Search {
+
+AhoCorasick::AhoCorasick(): m_maxlength(0), m_dirty(true)
+{
+    m_trie.emplace_back(); // Root
+    std::fill_n(m_root, 256, 0);
+}
+
+size_t AhoCorasick::add(const u8 *data, u64 size)
+{
+    if(!data || !size)
+        return m_entries.size();
+
+    return this->insert(data, { nullptr, size, 0, size });
+}
+
+size_t AhoCorasick::add(const std::string &s) { return this->add(reinterpret_cast<const u8*>(s.data()), s.size()); }
+
+size_t AhoCorasick::add(const CompiledPatternPtr &pattern)
+{
+    if(!pattern || !pattern->isValid())
+        return m_entries.size();
+
+    const std::vector<u8>& mask = pattern->mask();
+    u64 keyoffset = 0, keysize = 0;
+
+    for(u64 i = pattern->anchor(); i <= pattern->last(); )
+    {
+        if(!mask[i])
+        {
+            i++;
+            continue;
+        }
+
+        u64 j = i;
+
+        while((j <= pattern->last()) && mask[j])
+            j++;
+
+        if((j - i) > keysize)
+        {
+            keyoffset = i;
+            keysize = j - i;
+        }
+
+        i = j;
+    }
+
+    return this->insert(pattern->value().data() + keyoffset, { pattern, pattern->size(), keyoffset, keysize });
+}
+
+size_t AhoCorasick::addWildcard(const std::string &pattern) { return this->add(std::make_shared<CompiledPattern>(pattern)); }
+size_t AhoCorasick::size() const { return m_entries.size(); }
+u64 AhoCorasick::maxLength() const { return m_maxlength; }
+
+void AhoCorasick::build()
+{
+    if(!m_dirty)
+        return;
+
+    m_states.assign(m_trie.size(), { 0, AC_NO_STATE, 0, 0, 0, 0 });
+    m_edges.clear();
+    m_matches.clear();
+
+    for(size_t i = 0; i < m_trie.size(); i++) // Flatten the trie, edges are sorted for binary search
+    {
+        TrieNode& node = m_trie[i];
+        State& state = m_states[i];
+
+        std::sort(node.edges.begin(), node.edges.end(), [](const Edge& e1, const Edge& e2) -> bool { return e1.value < e2.value; });
+        state.edgebegin = static_cast<u32>(m_edges.size());
+        state.edgecount = static_cast<u32>(node.edges.size());
+        state.matchbegin = static_cast<u32>(m_matches.size());
+        state.matchcount = static_cast<u32>(node.matches.size());
+        m_edges.insert(m_edges.end(), node.edges.begin(), node.edges.end());
+        m_matches.insert(m_matches.end(), node.matches.begin(), node.matches.end());
+    }
+
+    std::fill_n(m_root, 256, 0);
+
+    for(const Edge& edge : m_trie.front().edges)
+        m_root[edge.value] = edge.target;
+
+    std::deque<u32> pending;
+
+    for(const Edge& edge : m_trie.front().edges)
+        pending.push_back(edge.target);
+
+    while(!pending.empty()) // Breadth first, fail links point to shallower states
+    {
+        u32 s = pending.front();
+        pending.pop_front();
+
+        for(const Edge& edge : m_trie[s].edges)
+        {
+            u32 f = m_states[s].fail, n = AC_NO_STATE;
+
+            while((n = this->next(f, edge.value)) == AC_NO_STATE)
+                f = m_states[f].fail;
+
+            State& child = m_states[edge.target];
+            child.fail = n;
+            child.output = m_states[n].matchcount ? n : m_states[n].output;
+            pending.push_back(edge.target);
+        }
+    }
+
+    m_dirty = false;
+}
+
+void AhoCorasick::scan(const u8 *data, u64 size, const MatchCallback &cb) const
+{
+    if(m_dirty || !data || !size)
+        return;
+
+    u32 state = 0;
+
+    for(u64 i = 0; i < size; i++)
+    {
+        u32 n = AC_NO_STATE;
+
+        while((n = this->next(state, data[i])) == AC_NO_STATE)
+            state = m_states[state].fail;
+
+        state = n;
+
+        for(u32 s = m_states[state].matchcount ? state : m_states[state].output; s != AC_NO_STATE; s = m_states[s].output)
+        {
+            const State& matchstate = m_states[s];
+
+            for(u32 j = matchstate.matchbegin; j < (matchstate.matchbegin + matchstate.matchcount); j++)
+            {
+                const Entry& entry = m_entries[m_matches[j]];
+
+                if((i + 1) < (entry.keyoffset + entry.keysize))
+                    continue;
+
+                u64 start = (i + 1) - entry.keysize - entry.keyoffset;
+
+                if((entry.size > (size - start)) || (entry.pattern && !entry.pattern->match(data + start)))
+                    continue;
+
+                if(!cb(m_matches[j], start))
+                    return;
+            }
+        }
+    }
+}
+
+void AhoCorasick::scan(const BufferView &view, const MatchCallback &cb) const
+{
+    if(view.eob())
+        return;
+
+    this->scan(view.data(), view.size(), cb);
+}
+
+size_t AhoCorasick::insert(const u8 *key, const Entry &entry)
+{
+    u32 s = 0;
+
+    for(u64 i = 0; i < entry.keysize; i++)
+    {
+        std::vector<Edge>& edges = m_trie[s].edges;
+        auto it = std::find_if(edges.begin(), edges.end(), [&](const Edge& edge) -> bool { return edge.value == key[i]; });
+
+        if(it != edges.end())
+        {
+            s = it->target;
+            continue;
+        }
+
+        u32 target = static_cast<u32>(m_trie.size());
+        edges.push_back({ key[i], target });
+        m_trie.emplace_back(); // Invalidates 'edges'
+        s = target;
+    }
+
+    size_t idx = m_entries.size();
+    m_trie[s].matches.push_back(static_cast<u32>(idx));
+    m_entries.push_back(entry);
+    m_maxlength = std::max(m_maxlength, entry.size);
+    m_dirty = true;
+    return idx;
+}
+
+u32 AhoCorasick::next(u32 state, u8 value) const
+{
+    if(!state)
+        return m_root[value];
+
+    const State& s = m_states[state];
+    auto begin = m_edges.begin() + s.edgebegin, end = begin + s.edgecount;
+    auto it = std::lower_bound(begin, end, value, [](const Edge& edge, u8 v) -> bool { return edge.value < v; });
+    return ((it != end) && (it->value == value)) ? it->target : AC_NO_STATE;
+}
+
+} // namespace Search
+} // namespace REDasm
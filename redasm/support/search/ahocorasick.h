@@ -0,0 +1,52 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "../../types/buffer/bufferview.h"
+#include "compiledpattern.h"
+
+namespace REDasm {
+namespace Search {
+
+class AhoCorasick
+{
+    public:
+        typedef std::function<bool(size_t, u64)> MatchCallback; // (pattern index, start offset), return false to stop
+
+    private:
+        struct Edge { u8 value; u32 target; };
+        struct State { u32 fail, output, edgebegin, edgecount, matchbegin, matchcount; };
+        struct Entry { CompiledPatternPtr pattern; u64 size, keyoffset, keysize; }; // Wildcard patterns are keyed by their longest fixed run
+        struct TrieNode { std::vector<Edge> edges; std::vector<u32> matches; };
+
+    public:
+        AhoCorasick();
+        size_t add(const u8* data, u64 size);
+        size_t add(const std::string& s);
+        size_t add(const CompiledPatternPtr& pattern);
+        size_t addWildcard(const std::string& pattern);
+        size_t size() const;
+        u64 maxLength() const;
+        void build();                                                       // Call after the last add(), before scanning
+        void scan(const u8* data, u64 size, const MatchCallback& cb) const; // Matches are reported by end offset
+        void scan(const BufferView& view, const MatchCallback& cb) const;
+        template<typename T> size_t add(const T* pack) { return this->add(reinterpret_cast<const u8*>(pack), sizeof(T)); }
+
+    private:
+        size_t insert(const u8* key, const Entry& entry);
+        u32 next(u32 state, u8 value) const;
+
+    private:
+        std::vector<Entry> m_entries;
+        std::vector<TrieNode> m_trie;
+        std::vector<State> m_states;
+        std::vector<Edge> m_edges;
+        std::vector<u32> m_matches;
+        u32 m_root[256];
+        u64 m_maxlength;
+        bool m_dirty;
+};
+
+} // namespace Search
+} // namespace REDasm
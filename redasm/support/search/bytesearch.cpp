@@ -0,0 +1,149 @@
+#include "bytesearch.h"
+#include "cpufeatures.h"
+#include <algorithm>
+#include <cstring>
+
+#define SEARCH_LONG_NEEDLE 24 // Above this, Horspool's skips beat the first/last byte filter (see benchmarks/searchbench)
+
+namespace REDasm {
+namespace Search {
+
+namespace Detail {
+
+const u8* findScalar(const u8* data, u64 size, const u8* needle, u64 needlesize)
+{
+    const u8* plast = data + (size - needlesize);
+
+    for(const u8* p = data; p <= plast; p++)
+    {
+        p = static_cast<const u8*>(std::memchr(p, needle[0], static_cast<size_t>(plast - p) + 1));
+
+        if(!p)
+            break;
+
+        if(!std::memcmp(p + 1, needle + 1, needlesize - 1))
+            return p;
+    }
+
+    return nullptr;
+}
+
+const u8* findHorspool(const u8* data, u64 size, const u8* needle, u64 needlesize)
+{
+    u64 shift[256];
+    u64 last = needlesize - 1;
+    std::fill_n(shift, 256, needlesize);
+
+    for(u64 i = 0; i < last; i++)
+        shift[needle[i]] = last - i;
+
+    for(u64 pos = 0; pos <= (size - needlesize); )
+    {
+        u8 c = data[pos + last];
+
+        if((c == needle[last]) && !std::memcmp(data + pos, needle, last))
+            return data + pos;
+
+        pos += shift[c];
+    }
+
+    return nullptr;
+}
+
+#ifdef SEARCH_X86
+// Compare the first and the last byte of the needle at 16/32 positions at once,
+// only the candidates that survive both compares are verified with memcmp
+SEARCH_TARGET("sse2") const u8* findSSE2(const u8* data, u64 size, const u8* needle, u64 needlesize)
+{
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle[needlesize - 1]));
+    u64 i = 0;
+
+    for( ; (i + needlesize - 1 + 16) <= size; i += 16)
+    {
+        __m128i blockfirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i blocklast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + needlesize - 1));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockfirst, first), _mm_cmpeq_epi8(blocklast, last))));
+
+        while(mask)
+        {
+            const u8* p = data + i + CPU::lowestBit(mask);
+
+            if((needlesize <= 2) || !std::memcmp(p + 1, needle + 1, needlesize - 2))
+                return p;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return (i + needlesize <= size) ? findScalar(data + i, size - i, needle, needlesize) : nullptr;
+}
+
+SEARCH_TARGET("avx2") const u8* findAVX2(const u8* data, u64 size, const u8* needle, u64 needlesize)
+{
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0]));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(needle[needlesize - 1]));
+    u64 i = 0;
+
+    for( ; (i + needlesize - 1 + 32) <= size; i += 32)
+    {
+        __m256i blockfirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i blocklast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + needlesize - 1));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockfirst, first), _mm256_cmpeq_epi8(blocklast, last))));
+
+        while(mask)
+        {
+            const u8* p = data + i + CPU::lowestBit(mask);
+
+            if((needlesize <= 2) || !std::memcmp(p + 1, needle + 1, needlesize - 2))
+                return p;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return (i + needlesize <= size) ? findSSE2(data + i, size - i, needle, needlesize) : nullptr;
+}
+#else
+const u8* findSSE2(const u8* data, u64 size, const u8* needle, u64 needlesize) { return findScalar(data, size, needle, needlesize); }
+const u8* findAVX2(const u8* data, u64 size, const u8* needle, u64 needlesize) { return findScalar(data, size, needle, needlesize); }
+#endif // SEARCH_X86
+
+} // namespace Detail
+
+namespace {
+
+typedef const u8* (*FindCallback)(const u8*, u64, const u8*, u64);
+
+FindCallback selectFind()
+{
+#ifdef SEARCH_X86
+    if(CPU::hasAVX2())
+        return &Detail::findAVX2;
+
+    if(CPU::hasSSE2())
+        return &Detail::findSSE2;
+#endif
+
+    return &Detail::findScalar;
+}
+
+} // namespace
+
+const u8* find(const u8 *data, u64 size, const u8 *needle, u64 needlesize)
+{
+    if(!data || !needle || !needlesize || (needlesize > size))
+        return nullptr;
+
+    if(needlesize == 1)
+        return static_cast<const u8*>(std::memchr(data, needle[0], size));
+
+    if(needlesize > SEARCH_LONG_NEEDLE)
+        return Detail::findHorspool(data, size, needle, needlesize);
+
+    static const FindCallback findcb = selectFind();
+    return findcb(data, size, needle, needlesize);
+}
+
+} // namespace Search
+} // namespace REDasm
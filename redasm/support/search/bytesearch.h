@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../../types/base_types.h"
+
+namespace REDasm {
+namespace Search {
+
+const u8* find(const u8* data, u64 size, const u8* needle, u64 needlesize); // nullptr if not found
+
+namespace Detail { // The strategies find() picks from, they expect 1 <= needlesize <= size
+
+const u8* findScalar(const u8* data, u64 size, const u8* needle, u64 needlesize);
+const u8* findHorspool(const u8* data, u64 size, const u8* needle, u64 needlesize);
+const u8* findSSE2(const u8* data, u64 size, const u8* needle, u64 needlesize); // Needs CPU::hasSSE2() on x86
+const u8* findAVX2(const u8* data, u64 size, const u8* needle, u64 needlesize); // Needs CPU::hasAVX2() on x86
+
+} // namespace Detail
+
+} // namespace Search
+} // namespace REDasm
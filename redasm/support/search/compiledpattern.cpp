@@ -0,0 +1,215 @@
+#include "compiledpattern.h"
+#include "cpufeatures.h"
+#include <cctype>
+
+#define WILDCARD_CHAR '?'
+
+namespace REDasm {
+namespace Search {
+
+namespace {
+
+typedef const u8* (*FindCallback)(const CompiledPattern&, const u8*, u64);
+
+bool hexValue(char c, u8* val)
+{
+    if(!std::isxdigit(static_cast<unsigned char>(c)))
+        return false;
+
+    if(std::isdigit(static_cast<unsigned char>(c)))
+        *val = static_cast<u8>(c - '0');
+    else
+        *val = static_cast<u8>(std::tolower(static_cast<unsigned char>(c)) - 'a' + 10);
+
+    return true;
+}
+
+// 'count' is the number of candidate start positions
+const u8* scanScalar(const CompiledPattern& pattern, const u8* data, u64 from, u64 count)
+{
+    const u8 anchorbyte = pattern.value()[pattern.anchor()];
+
+    for(u64 i = from; i < count; i++)
+    {
+        if((data[i + pattern.anchor()] == anchorbyte) && pattern.match(data + i))
+            return data + i;
+    }
+
+    return nullptr;
+}
+
+const u8* findScalar(const CompiledPattern& pattern, const u8* data, u64 count) { return scanScalar(pattern, data, 0, count); }
+
+#ifdef SEARCH_X86
+// Same first/last byte filter as the exact search, anchored on the fixed bytes
+SEARCH_TARGET("sse2") const u8* findSSE2(const CompiledPattern& pattern, const u8* data, u64 count)
+{
+    u64 anchor = pattern.anchor(), last = pattern.last();
+    const __m128i first = _mm_set1_epi8(static_cast<char>(pattern.value()[anchor]));
+    const __m128i lastb = _mm_set1_epi8(static_cast<char>(pattern.value()[last]));
+    u64 i = 0;
+
+    for( ; (i + 16) <= count; i += 16)
+    {
+        __m128i blockfirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + anchor));
+        __m128i blocklast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + last));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockfirst, first), _mm_cmpeq_epi8(blocklast, lastb))));
+
+        while(mask)
+        {
+            const u8* p = data + i + CPU::lowestBit(mask);
+
+            if(pattern.match(p))
+                return p;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return scanScalar(pattern, data, i, count);
+}
+
+SEARCH_TARGET("avx2") const u8* findAVX2(const CompiledPattern& pattern, const u8* data, u64 count)
+{
+    u64 anchor = pattern.anchor(), last = pattern.last();
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern.value()[anchor]));
+    const __m256i lastb = _mm256_set1_epi8(static_cast<char>(pattern.value()[last]));
+    u64 i = 0;
+
+    for( ; (i + 32) <= count; i += 32)
+    {
+        __m256i blockfirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + anchor));
+        __m256i blocklast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + last));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockfirst, first), _mm256_cmpeq_epi8(blocklast, lastb))));
+
+        while(mask)
+        {
+            const u8* p = data + i + CPU::lowestBit(mask);
+
+            if(pattern.match(p))
+                return p;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return scanScalar(pattern, data, i, count);
+}
+#endif // SEARCH_X86
+
+FindCallback selectFind()
+{
+#ifdef SEARCH_X86
+    if(CPU::hasAVX2())
+        return &findAVX2;
+
+    if(CPU::hasSSE2())
+        return &findSSE2;
+#endif
+
+    return &findScalar;
+}
+
+} // namespace
+
+CompiledPattern::CompiledPattern(): m_anchor(0), m_last(0) { }
+CompiledPattern::CompiledPattern(const std::string &pattern): m_anchor(0), m_last(0) { this->compile(pattern); }
+bool CompiledPattern::isValid() const { return !m_value.empty(); }
+u64 CompiledPattern::size() const { return m_value.size(); }
+u64 CompiledPattern::anchor() const { return m_anchor; }
+u64 CompiledPattern::last() const { return m_last; }
+const std::vector<u8> &CompiledPattern::value() const { return m_value; }
+const std::vector<u8> &CompiledPattern::mask() const { return m_mask; }
+
+bool CompiledPattern::match(const u8 *data) const
+{
+    const u8* pdata = data + m_anchor;
+    const u8* pvalue = m_value.data() + m_anchor;
+    const u8* pmask = m_mask.data() + m_anchor;
+    u64 len = m_last - m_anchor + 1, i = 0;
+
+#ifdef SEARCH_SSE2_BASELINE
+    for( ; (i + 16) <= len; i += 16)
+    {
+        __m128i block = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pdata + i)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pmask + i)));
+
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pvalue + i)))) != 0xFFFF)
+            return false;
+    }
+#endif
+
+    for( ; i < len; i++)
+    {
+        if((pdata[i] & pmask[i]) != pvalue[i])
+            return false;
+    }
+
+    return true;
+}
+
+const u8 *CompiledPattern::find(const u8 *data, u64 size) const
+{
+    if(!this->isValid() || !data || (size < m_value.size()))
+        return nullptr;
+
+    static const FindCallback findcb = selectFind();
+    return findcb(*this, data, size - m_value.size() + 1);
+}
+
+bool CompiledPattern::compile(const std::string &pattern)
+{
+    std::string hexpattern;
+    hexpattern.reserve(pattern.size());
+
+    for(char c : pattern)
+    {
+        if(!std::isspace(static_cast<unsigned char>(c)))
+            hexpattern.push_back(c);
+    }
+
+    if(hexpattern.empty() || (hexpattern.size() % 2))
+        return false;
+
+    std::vector<u8> value, mask;
+    value.reserve(hexpattern.size() / 2);
+    mask.reserve(hexpattern.size() / 2);
+
+    for(size_t i = 0; i < hexpattern.size(); i += 2)
+    {
+        if((hexpattern[i] == WILDCARD_CHAR) && (hexpattern[i + 1] == WILDCARD_CHAR))
+        {
+            value.push_back(0);
+            mask.push_back(0);
+            continue;
+        }
+
+        u8 hi = 0, lo = 0;
+
+        if(!hexValue(hexpattern[i], &hi) || !hexValue(hexpattern[i + 1], &lo))
+            return false;
+
+        value.push_back(static_cast<u8>((hi << 4) | lo));
+        mask.push_back(0xFF);
+    }
+
+    u64 anchor = 0, last = mask.size();
+
+    while((anchor < mask.size()) && !mask[anchor])
+        anchor++;
+
+    if(anchor == mask.size()) // Wildcards only
+        return false;
+
+    while(!mask[last - 1])
+        last--;
+
+    m_value = std::move(value);
+    m_mask = std::move(mask);
+    m_anchor = anchor;
+    m_last = last - 1;
+    return true;
+}
+
+} // namespace Search
+} // namespace REDasm
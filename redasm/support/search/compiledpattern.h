@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../types/base_types.h"
+
+namespace REDasm {
+namespace Search {
+
+class CompiledPattern
+{
+    public:
+        CompiledPattern();
+        CompiledPattern(const std::string& pattern); // Hex bytes, "??" is a wildcard, whitespaces are ignored
+        bool isValid() const;
+        u64 size() const;
+        u64 anchor() const;
+        u64 last() const;
+        const std::vector<u8>& value() const;
+        const std::vector<u8>& mask() const;
+        bool match(const u8* data) const;                 // 'data' must hold at least size() bytes
+        const u8* find(const u8* data, u64 size) const;   // Returns the start of the pattern, leading wildcards included
+
+    private:
+        bool compile(const std::string& pattern);
+
+    private:
+        std::vector<u8> m_value, m_mask; // m_value is pre-masked
+        u64 m_anchor, m_last;            // First and last fixed byte
+};
+
+typedef std::shared_ptr<const CompiledPattern> CompiledPatternPtr;
+
+} // namespace Search
+} // namespace REDasm
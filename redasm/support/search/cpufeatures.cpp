@@ -0,0 +1,59 @@
+#include "cpufeatures.h"
+
+namespace REDasm {
+namespace Search {
+namespace CPU {
+
+namespace {
+
+bool detectAVX2()
+{
+#ifdef SEARCH_X86
+    #if _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+
+    if(info[0] < 7)
+        return false;
+
+    __cpuid(info, 1);
+
+    if(!(info[2] & (1 << 27)) || !(info[2] & (1 << 28))) // OSXSAVE + AVX
+        return false;
+
+    if((_xgetbv(0) & 0x6) != 0x6) // XMM and YMM state enabled by the OS
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+    #else
+    return __builtin_cpu_supports("avx2");
+    #endif
+#else
+    return false;
+#endif
+}
+
+} // namespace
+
+bool hasSSE2()
+{
+#if defined(SEARCH_SSE2_BASELINE)
+    return true;
+#elif defined(SEARCH_X86) && !_MSC_VER
+    static const bool sse2 = __builtin_cpu_supports("sse2");
+    return sse2;
+#else
+    return false;
+#endif
+}
+
+bool hasAVX2()
+{
+    static const bool avx2 = detectAVX2();
+    return avx2;
+}
+
+} // namespace CPU
+} // namespace Search
+} // namespace REDasm
@@ -0,0 +1,42 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define SEARCH_X86
+
+    #include <immintrin.h>
+
+    #if _MSC_VER
+        #include <intrin.h>
+        #define SEARCH_TARGET(isa)
+    #else
+        #define SEARCH_TARGET(isa) __attribute__((target(isa)))
+    #endif
+
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define SEARCH_SSE2_BASELINE // SSE2 can be used without dispatching
+    #endif
+#endif
+
+namespace REDasm {
+namespace Search {
+namespace CPU {
+
+bool hasSSE2();
+bool hasAVX2();
+
+#ifdef SEARCH_X86
+inline unsigned int lowestBit(unsigned int mask)
+{
+#if _MSC_VER
+    unsigned long idx = 0;
+    _BitScanForward(&idx, mask);
+    return idx;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+#endif // SEARCH_X86
+
+} // namespace CPU
+} // namespace Search
+} // namespace REDasm
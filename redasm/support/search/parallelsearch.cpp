@@ -0,0 +1,179 @@
+#include "parallelsearch.h"
+#include "bytesearch.h"
+#include "../concurrent/parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#define SEARCH_MIN_CHUNK_SIZE    0x100000 // Smaller views aren't worth a thread
+#define SEARCH_CHUNKS_PER_WORKER 4        // Keeps workers busy when matches are unevenly distributed
+#define SEARCH_NO_MATCH          std::numeric_limits<u64>::max()
+
+namespace REDasm {
+namespace Search {
+
+namespace {
+
+struct Chunk { u64 start, end, scanend; }; // Owns [start, end), scans [start, scanend)
+
+std::vector<Chunk> splitChunks(u64 size, u64 maxlength)
+{
+    u64 overlap = maxlength ? (maxlength - 1) : 0;
+    u64 count = Parallel::concurrency() * SEARCH_CHUNKS_PER_WORKER;
+    u64 chunksize = std::max<u64>(SEARCH_MIN_CHUNK_SIZE, (size + count - 1) / count);
+    std::vector<Chunk> chunks;
+
+    for(u64 start = 0; start < size; start += chunksize)
+    {
+        u64 end = std::min(size, start + chunksize);
+        chunks.push_back({ start, end, std::min(size, end + overlap) });
+    }
+
+    return chunks;
+}
+
+} // namespace
+
+bool parallelFind(const BufferView &view, u64 maxlength, const FindCallback &cb, u64 *offset)
+{
+    if(view.eob() || !maxlength)
+        return false;
+
+    const u8* data = view.data();
+    std::vector<Chunk> chunks = splitChunks(view.size(), maxlength);
+    std::atomic<u64> best(SEARCH_NO_MATCH);
+
+    Parallel::forEach(chunks.size(), [&](size_t i) {
+        const Chunk& chunk = chunks[i];
+
+        if(chunk.start >= best.load()) // Chunks are handed out in order, an earlier one has matched already
+            return;
+
+        const u8* p = cb(data + chunk.start, chunk.scanend - chunk.start);
+
+        if(!p)
+            return;
+
+        u64 found = static_cast<u64>(p - data), current = best.load();
+
+        if(found >= chunk.end) // Starts in the next chunk, it will be reported there
+            return;
+
+        while((found < current) && !best.compare_exchange_weak(current, found));
+    });
+
+    if(best.load() == SEARCH_NO_MATCH)
+        return false;
+
+    if(offset)
+        *offset = best.load();
+
+    return true;
+}
+
+Offsets parallelFindAll(const BufferView &view, u64 maxlength, const FindCallback &cb)
+{
+    if(view.eob() || !maxlength)
+        return Offsets();
+
+    const u8* data = view.data();
+    std::vector<Chunk> chunks = splitChunks(view.size(), maxlength);
+    std::vector<Offsets> results(chunks.size());
+
+    Parallel::forEach(chunks.size(), [&](size_t i) {
+        const Chunk& chunk = chunks[i];
+
+        for(u64 pos = chunk.start; pos < chunk.end; )
+        {
+            const u8* p = cb(data + pos, chunk.scanend - pos);
+
+            if(!p)
+                break;
+
+            u64 found = static_cast<u64>(p - data);
+
+            if(found >= chunk.end)
+                break;
+
+            results[i].push_back(found);
+            pos = found + 1;
+        }
+    });
+
+    Offsets offsets;
+
+    for(Offsets& result : results) // Chunk order is offset order
+        offsets.insert(offsets.end(), result.begin(), result.end());
+
+    return offsets;
+}
+
+bool parallelFind(const BufferView &view, const u8 *needle, u64 needlesize, u64 *offset)
+{
+    return parallelFind(view, needlesize, [needle, needlesize](const u8* data, u64 size) -> const u8* {
+        return Search::find(data, size, needle, needlesize);
+    }, offset);
+}
+
+bool parallelFind(const BufferView &view, const CompiledPattern &pattern, u64 *offset)
+{
+    if(!pattern.isValid())
+        return false;
+
+    return parallelFind(view, pattern.size(), [&pattern](const u8* data, u64 size) -> const u8* {
+        return pattern.find(data, size);
+    }, offset);
+}
+
+Offsets parallelFindAll(const BufferView &view, const u8 *needle, u64 needlesize)
+{
+    return parallelFindAll(view, needlesize, [needle, needlesize](const u8* data, u64 size) -> const u8* {
+        return Search::find(data, size, needle, needlesize);
+    });
+}
+
+Offsets parallelFindAll(const BufferView &view, const CompiledPattern &pattern)
+{
+    if(!pattern.isValid())
+        return Offsets();
+
+    return parallelFindAll(view, pattern.size(), [&pattern](const u8* data, u64 size) -> const u8* {
+        return pattern.find(data, size);
+    });
+}
+
+Matches parallelFindAll(const BufferView &view, const AhoCorasick &matcher)
+{
+    if(view.eob() || !matcher.size())
+        return Matches();
+
+    const u8* data = view.data();
+    std::vector<Chunk> chunks = splitChunks(view.size(), matcher.maxLength());
+    std::vector<Matches> results(chunks.size());
+
+    Parallel::forEach(chunks.size(), [&](size_t i) {
+        const Chunk& chunk = chunks[i];
+        Matches& matches = results[i];
+
+        matcher.scan(data + chunk.start, chunk.scanend - chunk.start, [&](size_t idx, u64 offset) -> bool {
+            if((chunk.start + offset) < chunk.end)
+                matches.push_back({ idx, chunk.start + offset });
+
+            return true;
+        });
+
+        std::sort(matches.begin(), matches.end(), [](const Match& m1, const Match& m2) -> bool {
+            return (m1.offset == m2.offset) ? (m1.index < m2.index) : (m1.offset < m2.offset);
+        });
+    });
+
+    Matches matches;
+
+    for(Matches& result : results)
+        matches.insert(matches.end(), result.begin(), result.end());
+
+    return matches;
+}
+
+} // namespace Search
+} // namespace REDasm
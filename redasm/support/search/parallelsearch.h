@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "../../types/buffer/bufferview.h"
+#include "compiledpattern.h"
+#include "ahocorasick.h"
+
+namespace REDasm {
+namespace Search {
+
+struct Match { size_t index; u64 offset; };
+
+typedef std::function<const u8*(const u8*, u64)> FindCallback; // First match in [data, data + size), nullptr if none
+typedef std::vector<u64> Offsets;
+typedef std::vector<Match> Matches;
+
+// The view is split in chunks that overlap by 'maxlength - 1' bytes and scanned by all workers,
+// a match belongs to the chunk where it starts so the results don't depend on the chunking
+bool parallelFind(const BufferView& view, u64 maxlength, const FindCallback& cb, u64* offset); // Lowest offset
+Offsets parallelFindAll(const BufferView& view, u64 maxlength, const FindCallback& cb);        // Overlapping matches, ascending
+bool parallelFind(const BufferView& view, const u8* needle, u64 needlesize, u64* offset);
+bool parallelFind(const BufferView& view, const CompiledPattern& pattern, u64* offset);
+Offsets parallelFindAll(const BufferView& view, const u8* needle, u64 needlesize);
+Offsets parallelFindAll(const BufferView& view, const CompiledPattern& pattern);
+Matches parallelFindAll(const BufferView& view, const AhoCorasick& matcher);                  // Sorted by offset, then by pattern index
+
+} // namespace Search
+} // namespace REDasm
@@ -22,6 +22,7 @@ class AbstractBuffer
         virtual void resize(u64 size) = 0;
         virtual u8* data() const = 0;
         virtual u64 size() const = 0;
+        virtual bool makeWritable() { return true; } // Read-only buffers (ie. file mappings) switch to copy-on-write
         u8& operator[](u64 idx);
         u8 operator[](u64 idx) const;
 
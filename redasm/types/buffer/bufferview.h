@@ -6,6 +6,8 @@
 #include <cstring>
 #include "../base_types.h"
 #include "../endianness/endianness.h"
+#include "../../support/search/bytesearch.h"
+#include "../../support/search/compiledpattern.h"
 #include "abstractbuffer.h"
 
 namespace REDasm {
@@ -30,8 +32,6 @@ class BufferView
         typedef iterator<u8> byte_iterator;
 
     private:
-        static const std::string WILDCARD_BYTE;
-
         template<typename T> struct SearchObject {
             SearchObject(): view(nullptr), result(nullptr) { }
             SearchObject(const BufferView* view, u64 searchsize): view(view), result(nullptr), position(0), searchsize(searchsize) { }
@@ -53,10 +53,10 @@ class BufferView
 
         template<typename T> struct WildcardResult: public SearchObject<T> {
             WildcardResult(): SearchObject<T>() { }
-            WildcardResult(const BufferView* view, const std::string& searchwildcard, u64 searchsize): SearchObject<T>(view, searchsize), searchwildcard(searchwildcard) { }
-            WildcardResult<T> next() const { return this->view->template wildcard<T>(searchwildcard, this->position + this->searchsize); }
+            WildcardResult(const BufferView* view, const Search::CompiledPatternPtr& searchpattern): SearchObject<T>(view, searchpattern->size()), searchpattern(searchpattern) { }
+            WildcardResult<T> next() const { return this->view->template wildcard<T>(searchpattern, this->position + this->searchsize); }
 
-            std::string searchwildcard;
+            Search::CompiledPatternPtr searchpattern;
         };
 
     public:
@@ -78,7 +78,8 @@ class BufferView
         constexpr bool eob() const { return !m_buffer || !this->data() || !m_size; }
         constexpr u64 size() const { return m_size; }
         u8 operator *() const { return *this->data(); }
-        template<typename T> WildcardResult<T> wildcard(std::string pattern, u64 startoffset = 0) const;
+        template<typename T> WildcardResult<T> wildcard(const std::string& pattern, u64 startoffset = 0) const;
+        template<typename T> WildcardResult<T> wildcard(const Search::CompiledPatternPtr& pattern, u64 startoffset = 0) const;
         template<typename T> SearchResult<T> find(const std::string& s, u64 startoffset = 0) const;
         template<typename T> SearchResult<T> find(const T* pack, u64 startoffset = 0) const;
         template<typename T> SearchResult<T> find(const std::initializer_list<u8> initlist, u64 startoffset = 0) const;
@@ -93,10 +94,6 @@ class BufferView
 
     private:
         template<typename T> SearchResult<T> find(const u8* searchdata, size_t searchsize, u64 startoffset = 0) const;
-        size_t patternLength(const std::string& pattern) const;
-        std::pair<u8, u8> patternRange(std::string &pattern, u64& startoffset, u64& endoffset, u64 &beginoffset) const;
-        bool comparePattern(const std::string& pattern, const u8* pdata) const;
-        bool preparePattern(std::string& pattern) const;
         u8* endData() const { return this->data() ? (this->data() + this->size()) : nullptr; }
 
     protected:
@@ -104,33 +101,23 @@ class BufferView
         u64 m_offset, m_size;
 };
 
-template<typename T> BufferView::WildcardResult<T> BufferView::wildcard(std::string pattern, u64 startoffset) const
+template<typename T> BufferView::WildcardResult<T> BufferView::wildcard(const std::string& pattern, u64 startoffset) const
 {
-    if(!this->preparePattern(pattern))
-        return WildcardResult<T>();
+    return this->wildcard<T>(std::make_shared<Search::CompiledPattern>(pattern), startoffset);
+}
 
-    u64 beginoffset = 0, endoffset = startoffset, searchsize = this->patternLength(pattern);
-    auto bp = this->patternRange(pattern, startoffset, endoffset, beginoffset);
+template<typename T> BufferView::WildcardResult<T> BufferView::wildcard(const Search::CompiledPatternPtr& pattern, u64 startoffset) const
+{
+    if(this->eob() || !pattern || !pattern->isValid() || (startoffset >= this->size()))
+        return WildcardResult<T>();
 
-    WildcardResult<T> r(this, pattern, searchsize);
-    const u8* pdata = this->data() + startoffset;
+    WildcardResult<T> r(this, pattern);
+    const u8* pdata = pattern->find(this->data() + startoffset, this->size() - startoffset);
 
-    while(pdata < (this->endData() - searchsize))
+    if(pdata)
     {
-        if((*pdata != bp.first) && ((*pdata + searchsize) != bp.second))
-        {
-            pdata++;
-            continue;
-        }
-
-        if(this->comparePattern(pattern, pdata))
-        {
-            r.result = reinterpret_cast<T*>(pdata);
-            r.position = (pdata - this->data()) - beginoffset;
-            break;
-        }
-
-        pdata++;
+        r.result = reinterpret_cast<const T*>(pdata);
+        r.position = pdata - this->data();
     }
 
     return r;
@@ -156,23 +143,16 @@ template<typename T> BufferView::SearchResult<T> BufferView::find(const std::ini
 
 template<typename T> BufferView::SearchResult<T> BufferView::find(const u8* searchdata, size_t searchsize, u64 startoffset) const
 {
-    if(this->eob() || !searchdata || !searchsize || (searchsize > this->size()))
+    if(this->eob() || !searchdata || !searchsize || (startoffset >= this->size()) || (searchsize > (this->size() - startoffset)))
         return SearchResult<T>();
 
     SearchResult<T> r(this, searchdata, searchsize);
-    const u8* pdata = this->data() + startoffset;
+    const u8* pdata = Search::find(this->data() + startoffset, this->size() - startoffset, searchdata, searchsize);
 
-    while((pdata + searchsize) < this->endData())
+    if(pdata)
     {
-        if(!std::equal(pdata, pdata + searchsize, searchdata))
-        {
-            pdata++;
-            continue;
-        }
-
         r.result = reinterpret_cast<const T*>(pdata);
         r.position = pdata - this->data();
-        break;
     }
 
     return r;
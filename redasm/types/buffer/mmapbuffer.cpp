@@ -0,0 +1,172 @@
+#include "mmapbuffer.h"
+#include "../../redasm_macros.h"
+#include <stdexcept>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace REDasm {
+namespace Buffer {
+
+#ifdef _WIN32
+MMapBuffer::MMapBuffer(): m_data(nullptr), m_size(0), m_access(Access::ReadOnly), m_file(INVALID_HANDLE_VALUE), m_mapping(nullptr) { }
+#else
+MMapBuffer::MMapBuffer(): m_data(nullptr), m_size(0), m_access(Access::ReadOnly) { }
+#endif
+
+MMapBuffer::~MMapBuffer() { this->unmap(); }
+u8 *MMapBuffer::data() const { return m_data; }
+u64 MMapBuffer::size() const { return m_size; }
+void MMapBuffer::resize(u64) { throw std::logic_error("MMapBuffer::resize(): File mappings can't be resized"); }
+MMapBuffer::Access MMapBuffer::access() const { return m_access; }
+
+bool MMapBuffer::makeWritable()
+{
+    if(m_access == Access::CopyOnWrite)
+        return true;
+
+    if(!m_data)
+        return false;
+
+#ifdef _WIN32
+    DWORD oldprotect = 0; // Allowed because the section is created with PAGE_WRITECOPY
+
+    if(!VirtualProtect(m_data, static_cast<SIZE_T>(m_size), PAGE_WRITECOPY, &oldprotect))
+        return false;
+#else
+    if(::mprotect(m_data, static_cast<size_t>(m_size), PROT_READ | PROT_WRITE) == -1) // Private mapping: writes never reach the file
+        return false;
+#endif
+
+    m_access = Access::CopyOnWrite;
+    return true;
+}
+
+bool MMapBuffer::advise(Advice advice, u64 offset, u64 size) const
+{
+    if(!m_data || (offset >= m_size))
+        return false;
+
+    if((advice == Advice::DontNeed) && (m_access == Access::CopyOnWrite))
+        return false; // Would drop the private pages and bring back the file contents
+
+    if(!size || (size > (m_size - offset)))
+        size = m_size - offset;
+
+#ifdef _WIN32
+    RE_UNUSED(advice);
+    return false;
+#else
+    int madvice = MADV_NORMAL;
+
+    switch(advice)
+    {
+        case Advice::Sequential: madvice = MADV_SEQUENTIAL; break;
+        case Advice::Random:     madvice = MADV_RANDOM; break;
+        case Advice::WillNeed:   madvice = MADV_WILLNEED; break;
+        case Advice::DontNeed:   madvice = MADV_DONTNEED; break;
+        default: break;
+    }
+
+    u64 pagesize = static_cast<u64>(::sysconf(_SC_PAGESIZE));
+    u64 start = offset - (offset % pagesize); // madvise() wants a page aligned address
+    return ::madvise(m_data + start, static_cast<size_t>(size + (offset - start)), madvice) != -1;
+#endif
+}
+
+MMapBuffer *MMapBuffer::fromFile(const std::string &file, Access access)
+{
+    MMapBuffer* b = new MMapBuffer();
+
+    if(b->map(file, access))
+        return b;
+
+    delete b;
+    return nullptr;
+}
+
+bool MMapBuffer::map(const std::string &file, Access access)
+{
+    m_access = access;
+
+#ifdef _WIN32
+    m_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if(m_file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER filesize;
+
+    if(!GetFileSizeEx(m_file, &filesize) || !filesize.QuadPart)
+        return false;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr); // Leaves room for makeWritable()
+
+    if(!m_mapping)
+        return false;
+
+    m_data = reinterpret_cast<u8*>(MapViewOfFile(m_mapping, (access == Access::CopyOnWrite) ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+
+    if(!m_data)
+        return false;
+
+    m_size = static_cast<u64>(filesize.QuadPart);
+    return true;
+#else
+    int fd = ::open(file.c_str(), O_RDONLY);
+
+    if(fd == -1)
+        return false;
+
+    struct stat st;
+
+    if((::fstat(fd, &st) == -1) || !st.st_size)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    int prot = (access == Access::CopyOnWrite) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), prot, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps its own reference
+
+    if(data == MAP_FAILED)
+        return false;
+
+    m_data = reinterpret_cast<u8*>(data);
+    m_size = static_cast<u64>(st.st_size);
+    return true;
+#endif
+}
+
+void MMapBuffer::unmap()
+{
+#ifdef _WIN32
+    if(m_data)
+        UnmapViewOfFile(m_data);
+
+    if(m_mapping)
+        CloseHandle(m_mapping);
+
+    if(m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = nullptr;
+#else
+    if(m_data)
+        ::munmap(m_data, static_cast<size_t>(m_size));
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+} // namespace Buffer
+} // namespace REDasm
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include "abstractbuffer.h"
+
+namespace REDasm {
+namespace Buffer {
+
+class MMapBuffer: public AbstractBuffer // File mapping, never written back to disk
+{
+    public:
+        enum class Access { ReadOnly, CopyOnWrite };
+        enum class Advice { Normal, Sequential, Random, WillNeed, DontNeed };
+
+    public:
+        MMapBuffer();
+        MMapBuffer(const MMapBuffer&) = delete;
+        ~MMapBuffer();
+        u8* data() const override;
+        u64 size() const override;
+        void resize(u64 size) override;
+        bool makeWritable() override;
+        Access access() const;
+        bool advise(Advice advice, u64 offset = 0, u64 size = 0) const; // Hint only, a failure is harmless. DontNeed is refused on CopyOnWrite mappings
+
+    public:
+        static MMapBuffer* fromFile(const std::string& file, Access access = Access::ReadOnly);
+
+    private:
+        bool map(const std::string& file, Access access);
+        void unmap();
+
+    private:
+        u8* m_data;
+        u64 m_size;
+        Access m_access;
+
+#ifdef _WIN32
+        void *m_file, *m_mapping;
+#endif
+};
+
+} // namespace Buffer
+
+using MMapBuffer = Buffer::MMapBuffer;
+
+} // namespace REDasm